@@ -1,10 +1,11 @@
 /*This source code copyrighted by Lazy Foo' Productions (2004-2020)
 and may not be redistributed without written permission.*/
 
-// Using SDL, standard IO, and strings
+// Using SDL, standard IO, strings, and memory accounting
 #include <SDL2/SDL.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include "LMemory.h"
 
 // Screen dimension constants
 const int SCREEN_WIDTH = 640;
@@ -66,6 +67,7 @@ bool init() {
     } else {
       // Get window surface
       gScreenSurface = SDL_GetWindowSurface( gWindow );
+      LMemoryTrackSurface( gScreenSurface, "window surface" );
     }
   }
 
@@ -104,13 +106,18 @@ bool loadMedia() {
 }
 
 void close() {
+  // Report what was held and the peaks reached
+  LMemoryDump();
+
   // Deallocate surfaces
   for ( int i = 0; i < KEY_PRESS_SURFACE_TOTAL; ++i ) {
+    LMemoryUntrack( gKeyPressSurfaces[i] );
     SDL_FreeSurface( gKeyPressSurfaces[i] );
     gKeyPressSurfaces[i] = NULL;
   }
 
   // Destroy window
+  LMemoryUntrack( gScreenSurface );
   SDL_DestroyWindow( gWindow );
   gWindow = NULL;
 
@@ -124,6 +131,7 @@ SDL_Surface* loadSurface( char* path ) {
   if ( loadedSurface == NULL ) {
     printf( "Unable to load image %s! SDL Error: %s\n", path, SDL_GetError() );
   }
+  LMemoryTrackSurface( loadedSurface, path );
 
   return loadedSurface;
 }
@@ -174,6 +182,11 @@ int main() {
               gCurrentSurface = gKeyPressSurfaces[KEY_PRESS_SURFACE_RIGHT];
               break;
 
+            // Print memory held in surfaces, keeping the current one
+            case SDLK_m:
+              LMemoryDump();
+              break;
+
             default:
               gCurrentSurface = gKeyPressSurfaces[KEY_PRESS_SURFACE_DEFAULT];
               break;
@@ -0,0 +1,250 @@
+#ifndef LMEMORY_H
+#define LMEMORY_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longest owner name kept, longer ones are cut
+#define LMEMORY_OWNER_SIZE 64
+
+// What an allocation is
+typedef enum LMemoryKind {
+  LMEMORY_TEXTURE,
+  LMEMORY_SURFACE,
+  LMEMORY_KIND_TOTAL
+} LMemoryKind;
+
+// Tracked texture or surface
+typedef struct LMemoryAllocation LMemoryAllocation;
+
+// Allocations summed by owner or format for the report
+typedef struct LMemoryGroup LMemoryGroup;
+
+// Accounting of pixel memory held in textures and surfaces
+// Every tracked allocation carries its owner, usually the asset path or the
+// cache holding it, with its pixel format and size in bytes. Current and
+// peak totals are kept per kind and the report groups allocations by owner
+// and by format, largest first. Tracking is process wide and thread safe
+typedef struct LMemory LMemory;
+
+// Starts tracking texture under owner
+void LMemoryTrackTexture( SDL_Texture* texture, const char* owner );
+
+// Starts tracking surface under owner
+void LMemoryTrackSurface( SDL_Surface* surface, const char* owner );
+
+// Stops tracking texture or surface, call before destroying it
+void LMemoryUntrack( const void* handle );
+
+// Returns bytes currently held in textures or surfaces
+size_t LMemoryCurrent( LMemoryKind kind );
+
+// Returns most bytes ever held in textures or surfaces
+size_t LMemoryPeak( LMemoryKind kind );
+
+// Prints totals and allocations grouped by owner and format, largest first
+void LMemoryDump( void );
+
+typedef struct LMemoryAllocation {
+  const void* mHandle;
+  LMemoryKind mKind;
+  char mOwner[LMEMORY_OWNER_SIZE];
+  Uint32 mFormat;
+  size_t mBytes;
+} LMemoryAllocation;
+
+typedef struct LMemoryGroup {
+  LMemoryKind mKind;
+  const char* mOwner;
+  Uint32 mFormat;
+  size_t mBytes;
+  int mCount;
+} LMemoryGroup;
+
+typedef struct LMemory {
+  LMemoryAllocation* mAllocations;
+  int mCount;
+  int mCapacity;
+
+  // Bytes per kind now and at most, and both kinds together at most
+  size_t mCurrent[LMEMORY_KIND_TOTAL];
+  size_t mPeak[LMEMORY_KIND_TOTAL];
+  size_t mPeakTotal;
+
+  SDL_SpinLock mLock;
+} LMemory;
+
+// The process wide accounting
+static LMemory gLMemory;
+
+// Adds allocation, replacing an earlier one with the same handle
+static void LMemoryTrack( const void* handle, LMemoryKind kind,
+                          const char* owner, Uint32 format, size_t bytes ) {
+  if ( handle == NULL ) {
+    return;
+  }
+  LMemoryUntrack( handle );
+
+  SDL_AtomicLock( &gLMemory.mLock );
+  if ( gLMemory.mCount == gLMemory.mCapacity ) {
+    int capacity = gLMemory.mCapacity > 0 ? gLMemory.mCapacity * 2 : 64;
+    LMemoryAllocation* allocations = (LMemoryAllocation*)realloc(
+        gLMemory.mAllocations, sizeof( LMemoryAllocation ) * (size_t)capacity );
+    if ( allocations == NULL ) {
+      SDL_AtomicUnlock( &gLMemory.mLock );
+      printf( "Unable to track %s!\n", owner );
+      return;
+    }
+    gLMemory.mAllocations = allocations;
+    gLMemory.mCapacity = capacity;
+  }
+
+  LMemoryAllocation* allocation = &gLMemory.mAllocations[gLMemory.mCount++];
+  allocation->mHandle = handle;
+  allocation->mKind = kind;
+  snprintf( allocation->mOwner, sizeof( allocation->mOwner ), "%s", owner );
+  allocation->mFormat = format;
+  allocation->mBytes = bytes;
+
+  gLMemory.mCurrent[kind] += bytes;
+  gLMemory.mPeak[kind] =
+      SDL_max( gLMemory.mPeak[kind], gLMemory.mCurrent[kind] );
+  size_t total = 0;
+  for ( int i = 0; i < LMEMORY_KIND_TOTAL; ++i ) {
+    total += gLMemory.mCurrent[i];
+  }
+  gLMemory.mPeakTotal = SDL_max( gLMemory.mPeakTotal, total );
+  SDL_AtomicUnlock( &gLMemory.mLock );
+}
+
+void LMemoryTrackTexture( SDL_Texture* texture, const char* owner ) {
+  Uint32 format;
+  int width;
+  int height;
+  if ( texture == NULL ||
+       SDL_QueryTexture( texture, &format, NULL, &width, &height ) != 0 ) {
+    return;
+  }
+
+  // Planar YUV keeps chroma at quarter resolution
+  size_t bytes;
+  if ( SDL_ISPIXELFORMAT_FOURCC( format ) ) {
+    bytes = (size_t)width * (size_t)height +
+            2 * (size_t)( ( width + 1 ) / 2 ) * (size_t)( ( height + 1 ) / 2 );
+  } else {
+    bytes = (size_t)width * (size_t)height *
+            (size_t)SDL_BYTESPERPIXEL( format );
+  }
+  LMemoryTrack( texture, LMEMORY_TEXTURE, owner, format, bytes );
+}
+
+void LMemoryTrackSurface( SDL_Surface* surface, const char* owner ) {
+  if ( surface != NULL ) {
+    LMemoryTrack( surface, LMEMORY_SURFACE, owner, surface->format->format,
+                  (size_t)surface->pitch * (size_t)surface->h );
+  }
+}
+
+void LMemoryUntrack( const void* handle ) {
+  if ( handle == NULL ) {
+    return;
+  }
+  SDL_AtomicLock( &gLMemory.mLock );
+  for ( int i = 0; i < gLMemory.mCount; ++i ) {
+    LMemoryAllocation* allocation = &gLMemory.mAllocations[i];
+    if ( allocation->mHandle == handle ) {
+      gLMemory.mCurrent[allocation->mKind] -= allocation->mBytes;
+      *allocation = gLMemory.mAllocations[--gLMemory.mCount];
+      break;
+    }
+  }
+  SDL_AtomicUnlock( &gLMemory.mLock );
+}
+
+size_t LMemoryCurrent( LMemoryKind kind ) {
+  return gLMemory.mCurrent[kind];
+}
+
+size_t LMemoryPeak( LMemoryKind kind ) {
+  return gLMemory.mPeak[kind];
+}
+
+// Orders groups by bytes, largest first
+static int LMemoryCompareBytes( const void* a, const void* b ) {
+  size_t bytesA = ( (const LMemoryGroup*)a )->mBytes;
+  size_t bytesB = ( (const LMemoryGroup*)b )->mBytes;
+  return bytesA < bytesB ? 1 : bytesA > bytesB ? -1 : 0;
+}
+
+// Sums allocations sharing kind and owner, or kind and format
+static int LMemoryGroupAllocations( LMemoryGroup* groups, bool byOwner ) {
+  int groupCount = 0;
+  for ( int i = 0; i < gLMemory.mCount; ++i ) {
+    const LMemoryAllocation* allocation = &gLMemory.mAllocations[i];
+    int group = 0;
+    for ( ; group < groupCount; ++group ) {
+      if ( groups[group].mKind == allocation->mKind &&
+           ( byOwner ? strcmp( groups[group].mOwner, allocation->mOwner ) == 0
+                     : groups[group].mFormat == allocation->mFormat ) ) {
+        break;
+      }
+    }
+    if ( group == groupCount ) {
+      groups[group].mKind = allocation->mKind;
+      groups[group].mOwner = allocation->mOwner;
+      groups[group].mFormat = allocation->mFormat;
+      groups[group].mBytes = 0;
+      groups[group].mCount = 0;
+      ++groupCount;
+    }
+    groups[group].mBytes += allocation->mBytes;
+    ++groups[group].mCount;
+  }
+  qsort( groups, (size_t)groupCount, sizeof( LMemoryGroup ),
+         LMemoryCompareBytes );
+  return groupCount;
+}
+
+void LMemoryDump() {
+  const char* kindNames[LMEMORY_KIND_TOTAL] = { "texture", "surface" };
+
+  SDL_AtomicLock( &gLMemory.mLock );
+  printf( "Textures %.1f KB (peak %.1f KB), surfaces %.1f KB (peak %.1f KB), "
+          "peak together %.1f KB\n",
+          (double)gLMemory.mCurrent[LMEMORY_TEXTURE] / 1024.0,
+          (double)gLMemory.mPeak[LMEMORY_TEXTURE] / 1024.0,
+          (double)gLMemory.mCurrent[LMEMORY_SURFACE] / 1024.0,
+          (double)gLMemory.mPeak[LMEMORY_SURFACE] / 1024.0,
+          (double)gLMemory.mPeakTotal / 1024.0 );
+
+  LMemoryGroup* groups = (LMemoryGroup*)malloc(
+      sizeof( LMemoryGroup ) * (size_t)( gLMemory.mCount + 1 ) );
+  if ( groups == NULL ) {
+    SDL_AtomicUnlock( &gLMemory.mLock );
+    printf( "Unable to allocate memory report!\n" );
+    return;
+  }
+
+  // Owner names point into the allocations, so report before unlocking
+  int groupCount = LMemoryGroupAllocations( groups, false );
+  printf( "By format:\n" );
+  for ( int i = 0; i < groupCount; ++i ) {
+    printf( "  %10.1f KB  %-7s %4d  %s\n", (double)groups[i].mBytes / 1024.0,
+            kindNames[groups[i].mKind], groups[i].mCount,
+            SDL_GetPixelFormatName( groups[i].mFormat ) );
+  }
+
+  groupCount = LMemoryGroupAllocations( groups, true );
+  printf( "By owner:\n" );
+  for ( int i = 0; i < groupCount; ++i ) {
+    printf( "  %10.1f KB  %-7s %4d  %s\n", (double)groups[i].mBytes / 1024.0,
+            kindNames[groups[i].mKind], groups[i].mCount, groups[i].mOwner );
+  }
+  SDL_AtomicUnlock( &gLMemory.mLock );
+  free( groups );
+}
+
+#endif
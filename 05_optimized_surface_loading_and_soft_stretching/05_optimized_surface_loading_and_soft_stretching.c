@@ -1,10 +1,11 @@
 /*This source code copyrighted by Lazy Foo' Productions (2004-2020)
 and may not be redistributed without written permission.*/
 
-// Using SDL, standard IO, and strings
+// Using SDL, standard IO, strings, and memory accounting
 #include <SDL2/SDL.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include "LMemory.h"
 
 // Screen dimension constants
 const int SCREEN_WIDTH = 640;
@@ -50,6 +51,7 @@ bool init() {
     } else {
       // Get window surface
       gScreenSurface = SDL_GetWindowSurface( gWindow );
+      LMemoryTrackSurface( gScreenSurface, "window surface" );
     }
   }
 
@@ -72,11 +74,16 @@ bool loadMedia() {
 }
 
 void close() {
+  // Report what was held and the peaks reached
+  LMemoryDump();
+
   // Free loaded image
+  LMemoryUntrack( gStretchedSurface );
   SDL_FreeSurface( gStretchedSurface );
   gStretchedSurface = NULL;
 
   // Destroy window
+  LMemoryUntrack( gScreenSurface );
   SDL_DestroyWindow( gWindow );
   gWindow = NULL;
 
@@ -93,15 +100,20 @@ SDL_Surface* loadSurface( char* path ) {
   if ( loadedSurface == NULL ) {
     printf( "Unable to load image %s! SDL Error: %s\n", path, SDL_GetError() );
   } else {
+    LMemoryTrackSurface( loadedSurface, path );
+
     // Convert surface to screen format
     optimizedSurface =
         SDL_ConvertSurface( loadedSurface, gScreenSurface->format, 0 );
     if ( optimizedSurface == NULL ) {
       printf( "Unable to optimize image %s! SDL Error: %s\n", path,
               SDL_GetError() );
+    } else {
+      LMemoryTrackSurface( optimizedSurface, path );
     }
 
     // Get rid of old loaded surface
+    LMemoryUntrack( loadedSurface );
     SDL_FreeSurface( loadedSurface );
   }
 
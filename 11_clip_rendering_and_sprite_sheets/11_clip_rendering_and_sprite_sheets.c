@@ -3,6 +3,7 @@ and may not be redistributed without written permission.*/
 
 // Using SDL, SDL_image, standard math, and strings
 #include "LTexture.h"
+#include "LLayer.h"
 
 // Screen dimension constants
 const int SCREEN_WIDTH = 640;
@@ -27,6 +28,9 @@ SDL_Renderer* gRenderer = NULL;
 SDL_Rect gSpriteClips[4];
 LTexture gSpriteSheetTexture;
 
+// Cached layer holding the static corner sprites
+LLayer gSpriteLayer;
+
 bool init() {
   // Initialization flag
   bool success = true;
@@ -49,8 +53,9 @@ bool init() {
       printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
       success = false;
     } else {
-      // Create renderer for window
-      gRenderer = SDL_CreateRenderer( gWindow, -1, SDL_RENDERER_ACCELERATED );
+      // Create renderer for window that can render to textures
+      gRenderer = SDL_CreateRenderer(
+          gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE );
       if ( gRenderer == NULL ) {
         printf( "Renderer could not be created! SDL Error: %s\n",
                 SDL_GetError() );
@@ -108,6 +113,13 @@ bool loadMedia() {
     gSpriteClips[3].y = 100;
     gSpriteClips[3].w = 100;
     gSpriteClips[3].h = 100;
+
+    // Create screen sized layer for corner sprites
+    if ( !LLayerCreate( &gSpriteLayer, gRenderer, SCREEN_WIDTH,
+                        SCREEN_HEIGHT ) ) {
+      printf( "Failed to create sprite layer!\n" );
+      success = false;
+    }
   }
 
   return success;
@@ -116,6 +128,7 @@ bool loadMedia() {
 void close() {
   // Free loaded images
   freeLTexture( &gSpriteSheetTexture );
+  LLayerFree( &gSpriteLayer );
 
   // Destroy window
   SDL_DestroyRenderer( gRenderer );
@@ -151,29 +164,43 @@ int main() {
           if ( e.type == SDL_QUIT ) {
             quit = true;
           }
+          // Target textures lost their contents
+          else if ( e.type == SDL_RENDER_TARGETS_RESET ) {
+            LLayerInvalidate( &gSpriteLayer );
+          }
         }
 
         // Clear screen
         SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
         SDL_RenderClear( gRenderer );
 
-        // Render top left sprite
-        renderLTexture( &gSpriteSheetTexture, 0, 0, &gSpriteClips[0],
-                        gRenderer );
-
-        // Render top right sprite
-        renderLTexture( &gSpriteSheetTexture, SCREEN_WIDTH - gSpriteClips[1].w,
-                        0, &gSpriteClips[1], gRenderer );
-
-        // Render bottom left sprite
-        renderLTexture( &gSpriteSheetTexture, 0,
-                        SCREEN_HEIGHT - gSpriteClips[2].h, &gSpriteClips[2],
-                        gRenderer );
+        // Draw corner sprites into their layer only when invalidated
+        if ( LLayerBegin( &gSpriteLayer, gRenderer ) ) {
+          // Render top left sprite
+          renderLTexture( &gSpriteSheetTexture, 0, 0, &gSpriteClips[0],
+                          gRenderer );
+
+          // Render top right sprite
+          renderLTexture( &gSpriteSheetTexture,
+                          SCREEN_WIDTH - gSpriteClips[1].w, 0, &gSpriteClips[1],
+                          gRenderer );
+
+          // Render bottom left sprite
+          renderLTexture( &gSpriteSheetTexture, 0,
+                          SCREEN_HEIGHT - gSpriteClips[2].h, &gSpriteClips[2],
+                          gRenderer );
+
+          // Render bottom right sprite
+          renderLTexture( &gSpriteSheetTexture,
+                          SCREEN_WIDTH - gSpriteClips[3].w,
+                          SCREEN_HEIGHT - gSpriteClips[3].h, &gSpriteClips[3],
+                          gRenderer );
+
+          LLayerEnd( &gSpriteLayer, gRenderer );
+        }
 
-        // Render bottom right sprite
-        renderLTexture( &gSpriteSheetTexture, SCREEN_WIDTH - gSpriteClips[3].w,
-                        SCREEN_HEIGHT - gSpriteClips[3].h, &gSpriteClips[3],
-                        gRenderer );
+        // Composite all sprites with a single copy
+        LLayerRender( &gSpriteLayer, gRenderer, 0, 0 );
 
         // Update screen
         SDL_RenderPresent( gRenderer );
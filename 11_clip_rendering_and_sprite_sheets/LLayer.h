@@ -0,0 +1,121 @@
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// Cached render target layer struct
+// Groups static draws into one target texture that is only redrawn when
+// invalidated, so compositing it costs a single copy per frame. Blending into
+// the transparent layer is exact for color keyed sprites and solid text.
+typedef struct LLayer LLayer;
+
+// creates LLayer with default values
+LLayer LLayerNew( void );
+
+// Deallocates LLayer
+void LLayerFree( LLayer* lLayer );
+
+// Creates target texture of given size for LLayer
+bool LLayerCreate( LLayer* lLayer, SDL_Renderer* gRenderer, int width,
+                   int height );
+
+// Marks contents as changed, call on SDL_RENDER_TARGETS_RESET as well
+void LLayerInvalidate( LLayer* lLayer );
+
+// Redirects rendering into layer if it needs redrawing
+// Returns false while cached contents are still valid
+bool LLayerBegin( LLayer* lLayer, SDL_Renderer* gRenderer );
+
+// Restores previous render target and marks layer as valid
+void LLayerEnd( LLayer* lLayer, SDL_Renderer* gRenderer );
+
+// Composites layer at given point
+void LLayerRender( LLayer* lLayer, SDL_Renderer* gRenderer, int x, int y );
+
+typedef struct LLayer {
+  // The render target texture
+  SDL_Texture* mTexture;
+
+  // Target to restore after drawing into layer
+  SDL_Texture* mPreviousTarget;
+
+  // Layer dimensions
+  int mWidth;
+  int mHeight;
+
+  // Whether contents need to be redrawn
+  bool mDirty;
+} LLayer;
+
+LLayer LLayerNew() {
+  LLayer lLayer = { NULL, NULL, 0, 0, true };
+  return lLayer;
+}
+
+void LLayerFree( LLayer* lLayer ) {
+  if ( lLayer->mTexture != NULL ) {
+    SDL_DestroyTexture( lLayer->mTexture );
+    lLayer->mTexture = NULL;
+    lLayer->mWidth = 0;
+    lLayer->mHeight = 0;
+  }
+  lLayer->mDirty = true;
+}
+
+bool LLayerCreate( LLayer* lLayer, SDL_Renderer* gRenderer, int width,
+                   int height ) {
+  // Get rid of preexisting texture
+  LLayerFree( lLayer );
+
+  // Create target texture with alpha so uncovered areas stay transparent
+  lLayer->mTexture =
+      SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_ARGB8888,
+                         SDL_TEXTUREACCESS_TARGET, width, height );
+  if ( lLayer->mTexture == NULL ) {
+    printf( "Unable to create layer texture! SDL Error: %s\n",
+            SDL_GetError() );
+    return false;
+  }
+  SDL_SetTextureBlendMode( lLayer->mTexture, SDL_BLENDMODE_BLEND );
+
+  lLayer->mWidth = width;
+  lLayer->mHeight = height;
+  return true;
+}
+
+void LLayerInvalidate( LLayer* lLayer ) { lLayer->mDirty = true; }
+
+bool LLayerBegin( LLayer* lLayer, SDL_Renderer* gRenderer ) {
+  if ( !lLayer->mDirty || lLayer->mTexture == NULL ) {
+    return false;
+  }
+
+  // Redirect rendering into layer
+  lLayer->mPreviousTarget = SDL_GetRenderTarget( gRenderer );
+  if ( SDL_SetRenderTarget( gRenderer, lLayer->mTexture ) != 0 ) {
+    printf( "Unable to render to layer! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  // Clear to transparent, keeping the caller's draw color
+  Uint8 r, g, b, a;
+  SDL_GetRenderDrawColor( gRenderer, &r, &g, &b, &a );
+  SDL_SetRenderDrawColor( gRenderer, 0, 0, 0, 0 );
+  SDL_RenderClear( gRenderer );
+  SDL_SetRenderDrawColor( gRenderer, r, g, b, a );
+
+  return true;
+}
+
+void LLayerEnd( LLayer* lLayer, SDL_Renderer* gRenderer ) {
+  SDL_SetRenderTarget( gRenderer, lLayer->mPreviousTarget );
+  lLayer->mPreviousTarget = NULL;
+  lLayer->mDirty = false;
+}
+
+void LLayerRender( LLayer* lLayer, SDL_Renderer* gRenderer, int x, int y ) {
+  SDL_Rect renderQuad = { x, y, lLayer->mWidth, lLayer->mHeight };
+  if ( SDL_RenderCopy( gRenderer, lLayer->mTexture, NULL, &renderQuad ) !=
+       0 ) {
+    printf( "Failed to render layer! SDL Error: %s\n", SDL_GetError() );
+  }
+}
@@ -3,11 +3,25 @@ and may not be redistributed without written permission.*/
 
 // Using SDL, SDL_image, standard math, and strings
 #include "LTexture.h"
+#include "LLatency.h"
+#include "LSpriteBatch.h"
 
 // Screen dimension constants
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+// Swatches along the bottom edge, each a differently tinted copy
+#define SWATCH_COUNT 10
+const int SWATCH_HEIGHT = 48;
+
+// Tint and alpha of each swatch
+const SDL_Color SWATCH_TINTS[SWATCH_COUNT] = {
+    { 0xFF, 0x00, 0x00, 0xFF }, { 0xFF, 0x80, 0x00, 0xFF },
+    { 0xFF, 0xFF, 0x00, 0xFF }, { 0x80, 0xFF, 0x00, 0xFF },
+    { 0x00, 0xFF, 0x00, 0xFF }, { 0x00, 0xFF, 0xFF, 0xFF },
+    { 0x00, 0x00, 0xFF, 0xFF }, { 0xFF, 0x00, 0xFF, 0xFF },
+    { 0xFF, 0xFF, 0xFF, 0x80 }, { 0x40, 0x40, 0x40, 0xFF } };
+
 // Starts up SDL and creates window
 bool init( void );
 
@@ -26,6 +40,12 @@ SDL_Renderer* gRenderer = NULL;
 // Scene texture
 LTexture gModulatedTexture;
 
+// Input to present latency measurement
+LLatency gLatency;
+
+// Tinted swatches drawn in one batch
+LSpriteBatch gSwatchBatch;
+
 bool init() {
   // Initialization flag
   bool success = true;
@@ -83,11 +103,22 @@ bool loadMedia() {
     success = false;
   }
 
+  // Room for every swatch
+  gSwatchBatch = LSpriteBatchNew();
+  if ( !LSpriteBatchCreate( &gSwatchBatch, SWATCH_COUNT ) ) {
+    printf( "Failed to create swatch batch!\n" );
+    success = false;
+  }
+
   return success;
 }
 
 void close() {
+  // Report latency
+  LLatencyPrint( &gLatency );
+
   // Free loaded images
+  LSpriteBatchFree( &gSwatchBatch );
   freeLTexture( &gModulatedTexture );
 
   // Destroy window
@@ -116,6 +147,9 @@ int main() {
       // Event handler
       SDL_Event e;
 
+      // Start measuring input latency
+      gLatency = LLatencyNew();
+
       // Modulation components
       Uint8 r = 255;
       Uint8 g = 255;
@@ -123,6 +157,9 @@ int main() {
 
       // While application is running
       while ( !quit ) {
+        // Sample input as late as possible when late latching
+        LLatencyBeginFrame( &gLatency );
+
         // Handle events on queue
         while ( SDL_PollEvent( &e ) != 0 ) {
           // User requests quit
@@ -131,6 +168,7 @@ int main() {
           }
           // On keypress change rgb values
           else if ( e.type == SDL_KEYDOWN ) {
+            LLatencyTagEvent( &gLatency, &e );
             switch ( e.key.keysym.sym ) {
             // Increase red
             case SDLK_q:
@@ -173,8 +211,20 @@ int main() {
         setColorLTexture( &gModulatedTexture, r, g, b );
         renderLTexture( &gModulatedTexture, 0, 0, NULL, gRenderer );
 
+        // Render every tinted swatch with one draw
+        LSpriteBatchBegin( &gSwatchBatch, &gModulatedTexture, gRenderer );
+        int swatchWidth = SCREEN_WIDTH / SWATCH_COUNT;
+        for ( int i = 0; i < SWATCH_COUNT; ++i ) {
+          SDL_Rect swatch = { i * swatchWidth, SCREEN_HEIGHT - SWATCH_HEIGHT,
+                              swatchWidth, SWATCH_HEIGHT };
+          LSpriteBatchDraw( &gSwatchBatch, NULL, &swatch, SWATCH_TINTS[i] );
+        }
+        LSpriteBatchEnd( &gSwatchBatch );
+
         // Update screen
+        LLatencySubmit( &gLatency );
         SDL_RenderPresent( gRenderer );
+        LLatencyPresented( &gLatency );
       }
     }
   }
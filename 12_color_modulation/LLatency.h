@@ -0,0 +1,173 @@
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// One millisecond histogram buckets, the last one collects everything longer
+#define LLATENCY_BUCKETS 128
+
+// Most tagged events waiting for one present
+#define LLATENCY_MAX_PENDING 64
+
+// Safety margin kept before the estimated present when late latching
+#define LLATENCY_LATCH_MARGIN_MS 2.0
+
+// Input to present latency histogram with optional late latched input
+// Events are tagged with their SDL timestamp and counted once the frame that
+// reflects them returns from SDL_RenderPresent. With late latching enabled
+// (LLATENCY_LATE_LATCH=1 in the environment) the frame start is delayed
+// by the expected idle time so input is polled as late as possible
+typedef struct LLatency LLatency;
+
+// creates LLatency, reading late latch setting from the environment
+LLatency LLatencyNew( void );
+
+// Waits for late latch if enabled, call before polling events
+void LLatencyBeginFrame( LLatency* lLatency );
+
+// Tags event that changes what the next frame shows
+void LLatencyTagEvent( LLatency* lLatency, const SDL_Event* e );
+
+// Tags input by its SDL timestamp, for events already translated
+void LLatencyTagTimestamp( LLatency* lLatency, Uint32 timestamp );
+
+// Call right before SDL_RenderPresent
+void LLatencySubmit( LLatency* lLatency );
+
+// Call right after SDL_RenderPresent returns
+void LLatencyPresented( LLatency* lLatency );
+
+// Prints percentiles and histogram
+void LLatencyPrint( LLatency* lLatency );
+
+typedef struct LLatency {
+  // Timestamps of tagged events not yet presented
+  Uint32 mPending[LLATENCY_MAX_PENDING];
+  int mPendingCount;
+
+  // Latencies in milliseconds
+  Uint64 mHistogram[LLATENCY_BUCKETS];
+  Uint64 mSamples;
+  Uint32 mMax;
+
+  // Whether to delay input polling towards the next present
+  bool mLateLatch;
+
+  // Performance counter marks for this frame
+  Uint64 mFrameStart;
+  Uint64 mSubmit;
+  Uint64 mLastPresent;
+
+  // Smoothed present interval and frame work time in milliseconds
+  double mFramePeriod;
+  double mWorkTime;
+} LLatency;
+
+LLatency LLatencyNew() {
+  LLatency lLatency;
+  memset( &lLatency, 0, sizeof( lLatency ) );
+  const char* lateLatch = SDL_getenv( "LLATENCY_LATE_LATCH" );
+  lLatency.mLateLatch = lateLatch != NULL && strcmp( lateLatch, "0" ) != 0;
+  return lLatency;
+}
+
+// Milliseconds between two performance counter values
+static double LLatencyMs( Uint64 from, Uint64 to ) {
+  return (double)( to - from ) * 1000.0 /
+         (double)SDL_GetPerformanceFrequency();
+}
+
+void LLatencyBeginFrame( LLatency* lLatency ) {
+  // Sleep through the part of the frame that would be spent waiting on vsync
+  if ( lLatency->mLateLatch && lLatency->mLastPresent != 0 ) {
+    double elapsed =
+        LLatencyMs( lLatency->mLastPresent, SDL_GetPerformanceCounter() );
+    double idle = lLatency->mFramePeriod - lLatency->mWorkTime - elapsed -
+                  LLATENCY_LATCH_MARGIN_MS;
+    if ( idle >= 1.0 ) {
+      SDL_Delay( (Uint32)idle );
+    }
+  }
+  lLatency->mFrameStart = SDL_GetPerformanceCounter();
+}
+
+void LLatencyTagEvent( LLatency* lLatency, const SDL_Event* e ) {
+  LLatencyTagTimestamp( lLatency, e->common.timestamp );
+}
+
+void LLatencyTagTimestamp( LLatency* lLatency, Uint32 timestamp ) {
+  if ( lLatency->mPendingCount < LLATENCY_MAX_PENDING ) {
+    lLatency->mPending[lLatency->mPendingCount++] = timestamp;
+  }
+}
+
+void LLatencySubmit( LLatency* lLatency ) {
+  lLatency->mSubmit = SDL_GetPerformanceCounter();
+}
+
+void LLatencyPresented( LLatency* lLatency ) {
+  Uint64 now = SDL_GetPerformanceCounter();
+  Uint32 ticks = SDL_GetTicks();
+
+  // Record latency of every event this frame reflects
+  for ( int i = 0; i < lLatency->mPendingCount; ++i ) {
+    Uint32 latency = ticks - lLatency->mPending[i];
+    ++lLatency->mHistogram[latency < LLATENCY_BUCKETS ? latency
+                                                      : LLATENCY_BUCKETS - 1];
+    ++lLatency->mSamples;
+    if ( latency > lLatency->mMax ) {
+      lLatency->mMax = latency;
+    }
+  }
+  lLatency->mPendingCount = 0;
+
+  // Track present interval and work time for late latching
+  double work = LLatencyMs( lLatency->mFrameStart, lLatency->mSubmit );
+  if ( lLatency->mLastPresent == 0 ) {
+    lLatency->mWorkTime = work;
+  } else {
+    double period = LLatencyMs( lLatency->mLastPresent, now );
+    lLatency->mFramePeriod = lLatency->mFramePeriod > 0.0
+                                 ? lLatency->mFramePeriod * 0.9 + period * 0.1
+                                 : period;
+
+    // React quickly to longer frames so latching doesn't miss vsync
+    lLatency->mWorkTime = work > lLatency->mWorkTime
+                              ? work
+                              : lLatency->mWorkTime * 0.9 + work * 0.1;
+  }
+  lLatency->mLastPresent = now;
+}
+
+// Smallest latency that at least fraction of samples don't exceed
+static Uint32 LLatencyPercentile( LLatency* lLatency, double fraction ) {
+  Uint64 target = (Uint64)( fraction * (double)lLatency->mSamples + 0.5 );
+  Uint64 seen = 0;
+  for ( Uint32 i = 0; i < LLATENCY_BUCKETS; ++i ) {
+    seen += lLatency->mHistogram[i];
+    if ( seen >= target && seen > 0 ) {
+      return i;
+    }
+  }
+  return LLATENCY_BUCKETS - 1;
+}
+
+void LLatencyPrint( LLatency* lLatency ) {
+  printf( "Input to present latency (late latch %s): %llu events\n",
+          lLatency->mLateLatch ? "on" : "off",
+          (unsigned long long)lLatency->mSamples );
+  if ( lLatency->mSamples == 0 ) {
+    return;
+  }
+  printf( "  p50 %u ms, p90 %u ms, p99 %u ms, max %u ms\n",
+          LLatencyPercentile( lLatency, 0.5 ),
+          LLatencyPercentile( lLatency, 0.9 ),
+          LLatencyPercentile( lLatency, 0.99 ), lLatency->mMax );
+  for ( int i = 0; i < LLATENCY_BUCKETS; ++i ) {
+    if ( lLatency->mHistogram[i] > 0 ) {
+      printf( "  %s%3d ms: %llu\n", i == LLATENCY_BUCKETS - 1 ? ">=" : "  ",
+              i, (unsigned long long)lLatency->mHistogram[i] );
+    }
+  }
+}
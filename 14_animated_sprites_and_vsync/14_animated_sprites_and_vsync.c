@@ -1,7 +1,8 @@
 /*This source code copyrighted by Lazy Foo' Productions (2004-2020)
 and may not be redistributed without written permission.*/
 
-// Using SDL, SDL_image, standard IO, and strings
+// Using SDL, SDL_image, standard IO, strings and asset packs
+#include "LPack.h"
 #include "LTexture.h"
 
 // Screen dimension constants
@@ -17,12 +18,19 @@ bool loadMedia( void );
 // Frees media and shuts down SDL
 void close( void );
 
+// Loads texture from the asset pack if it holds path, else from disk
+bool loadTexture( LTexture* lTexture, char* path );
+
 // The window we'll be rendering to
 SDL_Window* gWindow = NULL;
 
 // The window renderer
 SDL_Renderer* gRenderer = NULL;
 
+// Assets built by `make pack`, loose files are used when it's missing
+const char* ASSET_PACK = "14_animated_sprites_and_vsync/assets.pack";
+LPack gAssetPack;
+
 // Walking animation
 const int WALKING_ANIMATION_FRAMES = 4;
 SDL_Rect gSpriteClips[WALKING_ANIMATION_FRAMES];
@@ -75,14 +83,27 @@ bool init() {
   return success;
 }
 
+bool loadTexture( LTexture* lTexture, char* path ) {
+  SDL_RWops* stream = LPackOpenRW( &gAssetPack, path );
+  if ( stream != NULL ) {
+    return loadLTextureFromRW( lTexture, stream, path, gRenderer );
+  }
+  return loadLTextureFromFile( lTexture, path, gRenderer );
+}
+
 bool loadMedia() {
   // Loading success flag
   bool success = true;
 
+  // Map asset pack if one was built
+  gAssetPack = LPackNew();
+  if ( !LPackOpen( &gAssetPack, ASSET_PACK ) ) {
+    printf( "Loading loose files instead\n" );
+  }
+
   // Load sprite sheet texture
-  if ( !loadLTextureFromFile( &gSpriteSheetTexture,
-                              "14_animated_sprites_and_vsync/foo.png",
-                              gRenderer ) ) {
+  if ( !loadTexture( &gSpriteSheetTexture,
+                     "14_animated_sprites_and_vsync/foo.bmp" ) ) {
     printf( "Failed to load walking animation texture!\n" );
     success = false;
   } else {
@@ -114,6 +135,7 @@ bool loadMedia() {
 void close() {
   // Free loaded images
   freeLTexture( &gSpriteSheetTexture );
+  LPackFree( &gAssetPack );
 
   // Destroy window
   SDL_DestroyRenderer( gRenderer );
@@ -16,6 +16,11 @@ void freeLTexture( LTexture* lTexture );
 bool loadLTextureFromFile( LTexture* lTexture, char* path,
                            SDL_Renderer* gRenderer );
 
+// Loads image from stream for LTexture, name is used in errors
+// Closes the stream, so it works for files, memory and asset packs alike
+bool loadLTextureFromRW( LTexture* lTexture, SDL_RWops* stream, char* name,
+                         SDL_Renderer* gRenderer );
+
 // Renders texture at given point
 void renderLTexture( LTexture* lTexture, int x, int y, SDL_Rect* clip,
                      SDL_Renderer* gRenderer );
@@ -54,16 +59,27 @@ void freeLTexture( LTexture* lTexture ) {
 
 bool loadLTextureFromFile( LTexture* lTexture, char* path,
                            SDL_Renderer* gRenderer ) {
+  // Open image at specified path
+  SDL_RWops* stream = SDL_RWFromFile( path, "rb" );
+  if ( stream == NULL ) {
+    printf( "Unable to load image %s! SDL Error: %s\n", path, SDL_GetError() );
+    return false;
+  }
+  return loadLTextureFromRW( lTexture, stream, path, gRenderer );
+}
+
+bool loadLTextureFromRW( LTexture* lTexture, SDL_RWops* stream, char* name,
+                         SDL_Renderer* gRenderer ) {
   // Get rid of preexisting texture
   freeLTexture( lTexture );
 
   // The final texture
   SDL_Texture* newTexture = NULL;
 
-  // Load image at specified path
-  SDL_Surface* loadedSurface = IMG_Load( path );
+  // Decode image from stream
+  SDL_Surface* loadedSurface = IMG_Load_RW( stream, 1 );
   if ( loadedSurface == NULL ) {
-    printf( "Unable to load image %s! SDL_image Error: %s\n", path,
+    printf( "Unable to load image %s! SDL_image Error: %s\n", name,
             IMG_GetError() );
     return false;
   }
@@ -72,7 +88,7 @@ bool loadLTextureFromFile( LTexture* lTexture, char* path,
   if ( SDL_SetColorKey( loadedSurface, SDL_TRUE,
                         SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) ) !=
        0 ) {
-    printf( "Unable to load image %s! SDL_image Error: %s\n", path,
+    printf( "Unable to load image %s! SDL_image Error: %s\n", name,
             SDL_GetError() );
     return false;
   }
@@ -80,7 +96,7 @@ bool loadLTextureFromFile( LTexture* lTexture, char* path,
   // Create texture from surface pixels
   newTexture = SDL_CreateTextureFromSurface( gRenderer, loadedSurface );
   if ( newTexture == NULL ) {
-    printf( "Unable to create texture from %s! SDL Error: %s\n", path,
+    printf( "Unable to create texture from %s! SDL Error: %s\n", name,
             SDL_GetError() );
     return false;
   }
@@ -3,11 +3,18 @@ and may not be redistributed without written permission.*/
 
 // Using SDL, SDL_image, standard IO, math, and strings
 #include "LTexture.h"
+#include "LLatency.h"
+#include "LHotReload.h"
+#include "LInput.h"
+#include "LTrace.h"
 
 // Screen dimension constants
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+// Most input events handled per frame, the rest wait for the next frame
+const int MAX_EVENTS_PER_FRAME = 64;
+
 // Starts up SDL and creates window
 bool init( void );
 
@@ -26,10 +33,35 @@ SDL_Renderer* gRenderer = NULL;
 // Scene texture
 LTexture gArrowTexture;
 
+// Input to present latency measurement
+LLatency gLatency;
+
+// Rotations and flips the arrow can be drawn with
+const double gArrowAngles[] = { 0, 60, 120, 180, 240, 300 };
+const SDL_RendererFlip gArrowFlips[] = { SDL_FLIP_NONE, SDL_FLIP_HORIZONTAL,
+                                         SDL_FLIP_VERTICAL };
+
+// Prerenders all arrow variants so drawing skips the rotation path
+bool cacheArrowVariants( void );
+
+// Rebuilds variants after arrow image changed on disk
+void onArrowReloaded( const char* path, void* userData );
+
+// Watches assets for changes
+LHotReload gHotReload;
+
+// Input pumped off the render thread
+LInput gInput;
+
 bool init() {
   // Initialization flag
   bool success = true;
 
+  // Record a timeline when LTRACE_FILE is set
+  if ( LTraceInit() ) {
+    LTraceThreadName( "main" );
+  }
+
   // Initialize SDL
   if ( SDL_Init( SDL_INIT_VIDEO ) < 0 ) {
     printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
@@ -49,8 +81,10 @@ bool init() {
       success = false;
     } else {
       // Create vsynced renderer for window
-      gRenderer = SDL_CreateRenderer(
-          gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+      gRenderer = SDL_CreateRenderer( gWindow, -1,
+                                      SDL_RENDERER_ACCELERATED |
+                                          SDL_RENDERER_PRESENTVSYNC |
+                                          SDL_RENDERER_TARGETTEXTURE );
       if ( gRenderer == NULL ) {
         printf( "Renderer could not be created! SDL Error: %s\n",
                 SDL_GetError() );
@@ -82,12 +116,44 @@ bool loadMedia() {
                               "15_rotation_and_flipping/arrow.png" ) ) {
     printf( "Failed to load arrow texture!\n" );
     success = false;
+  } else if ( !cacheArrowVariants() ) {
+    // Not fatal, rendering falls back to general rotation
+    printf( "Failed to cache arrow variants!\n" );
   }
 
+  // Pick up edits to the arrow while running, not fatal where unsupported
+  LHotReloadWatchTexture( &gHotReload, &gArrowTexture,
+                          "15_rotation_and_flipping/arrow.png",
+                          onArrowReloaded, NULL );
+
   return success;
 }
 
+bool cacheArrowVariants() {
+  return LTextureCacheVariants(
+      &gArrowTexture, gRenderer, gArrowAngles, SDL_arraysize( gArrowAngles ),
+      gArrowFlips, SDL_arraysize( gArrowFlips ) );
+}
+
+void onArrowReloaded( const char* path, void* userData ) {
+  (void)path;
+  (void)userData;
+  cacheArrowVariants();
+}
+
 void close() {
+  // Report latency
+  LLatencyPrint( &gLatency );
+
+  // Report dropped input
+  LInputFree( &gInput );
+
+  // Stop watching before freeing what is watched
+  LHotReloadFree( &gHotReload );
+
+  // Write timeline once the decoder thread is done
+  LTraceFlush();
+
   // Free loaded images
   LTextureFree( &gArrowTexture );
 
@@ -114,8 +180,14 @@ int main() {
       // Main loop flag
       bool quit = false;
 
-      // Event handler
-      SDL_Event e;
+      // Events taken from the input queue this frame
+      LInputEvent events[LINPUT_QUEUE_SIZE];
+
+      // Queue of translated events
+      gInput = LInputNew();
+
+      // Start measuring input latency
+      gLatency = LLatencyNew();
 
       // Angle of rotation
       double degrees = 0;
@@ -125,13 +197,28 @@ int main() {
 
       // While application is running
       while ( !quit ) {
-        // Handle events on queue
-        while ( SDL_PollEvent( &e ) != 0 ) {
+        // Sample input as late as possible when late latching
+        LLatencyBeginFrame( &gLatency );
+
+        // Swap in assets changed on disk
+        LTraceBegin( "LHotReloadPoll" );
+        LHotReloadPoll( &gHotReload, gRenderer );
+        LTraceEnd();
+
+        // Handle a bounded number of queued events
+        int eventCount = LInputDrain( &gInput, events, MAX_EVENTS_PER_FRAME );
+        for ( int i = 0; i < eventCount; ++i ) {
+          LInputEvent* e = &events[i];
+
           // User requests quit
-          if ( e.type == SDL_QUIT ) {
+          if ( e->type == LINPUT_QUIT ) {
             quit = true;
-          } else if ( e.type == SDL_KEYDOWN ) {
-            switch ( e.key.keysym.sym ) {
+          } else if ( e->type == LINPUT_TARGETS_RESET ) {
+            // Atlas contents were lost
+            cacheArrowVariants();
+          } else if ( e->type == LINPUT_KEY_DOWN ) {
+            LLatencyTagTimestamp( &gLatency, e->timestamp );
+            switch ( e->key ) {
             case SDLK_a:
               degrees -= 60;
               break;
@@ -166,7 +253,9 @@ int main() {
                         degrees, NULL, flipType );
 
         // Update screen
+        LLatencySubmit( &gLatency );
         SDL_RenderPresent( gRenderer );
+        LLatencyPresented( &gLatency );
       }
     }
   }
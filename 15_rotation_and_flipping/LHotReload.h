@@ -0,0 +1,332 @@
+#include "LTexture.h"
+#include "LTrace.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/uio.h>
+#endif
+
+// Most files a reloader can watch
+#define LHOT_RELOAD_MAX_WATCHES 64
+
+// Called on the main thread after a watched file changed
+typedef void ( *LHotReloadCallback )( const char* path, void* userData );
+
+// Watched asset
+typedef struct LHotReloadWatch LHotReloadWatch;
+
+// Reloads assets whose files change on disk without restarting
+// A background thread waits on inotify and decodes changed images, the main
+// thread swaps them into their LTexture between frames with LHotReloadPoll
+typedef struct LHotReload LHotReload;
+
+// creates LHotReload with default values
+LHotReload LHotReloadNew( void );
+
+// Stops watching and deallocates LHotReload
+void LHotReloadFree( LHotReload* lHotReload );
+
+// Starts background watcher thread, returns false where inotify is missing
+bool LHotReloadStart( LHotReload* lHotReload );
+
+// Watches image at path and swaps it into texture, then calls callback
+// Cached variants of texture are dropped on swap, recache them in callback
+// Callback may be NULL
+bool LHotReloadWatchTexture( LHotReload* lHotReload, LTexture* lTexture,
+                             const char* path, LHotReloadCallback callback,
+                             void* userData );
+
+// Applies finished reloads, call between frames on the rendering thread
+void LHotReloadPoll( LHotReload* lHotReload, SDL_Renderer* gRenderer );
+
+typedef struct LHotReloadWatch {
+  // Watched file and its name inside the watched directory
+  char* mPath;
+  const char* mName;
+  int mDirectory;
+
+  // Texture to swap reloaded image into
+  LTexture* mTexture;
+
+  LHotReloadCallback mCallback;
+  void* mUserData;
+
+  // Decoded image waiting to be uploaded and whether file changed
+  SDL_Surface* mPending;
+  bool mChanged;
+} LHotReloadWatch;
+
+typedef struct LHotReload {
+  // Inotify descriptor, owned through stdio because the tutorials define
+  // their own close()
+  FILE* mNotify;
+
+  LHotReloadWatch mWatches[LHOT_RELOAD_MAX_WATCHES];
+  int mWatchCount;
+
+  // Watcher thread and lock guarding watches
+  SDL_Thread* mThread;
+  SDL_mutex* mMutex;
+  SDL_atomic_t mQuit;
+} LHotReload;
+
+LHotReload LHotReloadNew() {
+  LHotReload lHotReload;
+  memset( &lHotReload, 0, sizeof( lHotReload ) );
+  return lHotReload;
+}
+
+void LHotReloadFree( LHotReload* lHotReload ) {
+  // Stop watcher thread
+  if ( lHotReload->mThread != NULL ) {
+    SDL_AtomicSet( &lHotReload->mQuit, 1 );
+    SDL_WaitThread( lHotReload->mThread, NULL );
+  }
+  if ( lHotReload->mNotify != NULL ) {
+    fclose( lHotReload->mNotify );
+  }
+  if ( lHotReload->mMutex != NULL ) {
+    SDL_DestroyMutex( lHotReload->mMutex );
+  }
+
+  for ( int i = 0; i < lHotReload->mWatchCount; ++i ) {
+    SDL_FreeSurface( lHotReload->mWatches[i].mPending );
+    free( lHotReload->mWatches[i].mPath );
+  }
+
+  *lHotReload = LHotReloadNew();
+}
+
+#ifdef __linux__
+// Decodes image the same way LTextureLoadFromFile does
+static SDL_Surface* LHotReloadDecode( const char* path ) {
+  LTraceBeginDetail( "IMG_Load", path );
+  SDL_Surface* loadedSurface = IMG_Load( path );
+  LTraceEnd();
+  if ( loadedSurface == NULL ) {
+    printf( "Unable to reload image %s! SDL_image Error: %s\n", path,
+            IMG_GetError() );
+    return NULL;
+  }
+
+  // Color key image
+  SDL_SetColorKey( loadedSurface, SDL_TRUE,
+                   SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) );
+  return loadedSurface;
+}
+
+// Waits for file events and decodes changed images off the main thread
+static int LHotReloadThread( void* data ) {
+  LHotReload* lHotReload = (LHotReload*)data;
+  int fd = fileno( lHotReload->mNotify );
+  LTraceThreadName( "LHotReload" );
+
+  // Buffer aligned for struct inotify_event
+  union {
+    struct inotify_event event;
+    char bytes[4096];
+  } buffer;
+
+  while ( !SDL_AtomicGet( &lHotReload->mQuit ) ) {
+    // Wake up periodically to notice shutdown
+    struct pollfd pending = { fd, POLLIN, 0 };
+    if ( poll( &pending, 1, 100 ) <= 0 ) {
+      continue;
+    }
+
+    struct iovec vector = { buffer.bytes, sizeof( buffer.bytes ) };
+    ssize_t length = readv( fd, &vector, 1 );
+    for ( ssize_t offset = 0; offset < length; ) {
+      const struct inotify_event* event =
+          (const struct inotify_event*)( buffer.bytes + offset );
+      offset += (ssize_t)( sizeof( struct inotify_event ) + event->len );
+      if ( event->len == 0 ) {
+        continue;
+      }
+
+      // Watches below the count are fully set up and never change
+      SDL_LockMutex( lHotReload->mMutex );
+      int watchCount = lHotReload->mWatchCount;
+      SDL_UnlockMutex( lHotReload->mMutex );
+
+      for ( int i = 0; i < watchCount; ++i ) {
+        LHotReloadWatch* watch = &lHotReload->mWatches[i];
+        if ( watch->mDirectory != event->wd ||
+             strcmp( watch->mName, event->name ) != 0 ) {
+          continue;
+        }
+
+        // Decode without holding the lock
+        SDL_Surface* decoded = LHotReloadDecode( watch->mPath );
+        if ( decoded == NULL ) {
+          continue;
+        }
+
+        // Hand over newest version, dropping one the main thread never took
+        SDL_LockMutex( lHotReload->mMutex );
+        SDL_FreeSurface( watch->mPending );
+        watch->mPending = decoded;
+        watch->mChanged = true;
+        SDL_UnlockMutex( lHotReload->mMutex );
+      }
+    }
+  }
+
+  return 0;
+}
+#endif
+
+bool LHotReloadStart( LHotReload* lHotReload ) {
+#ifdef __linux__
+  if ( lHotReload->mNotify == NULL ) {
+    int fd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+    lHotReload->mNotify = fd >= 0 ? fdopen( fd, "r" ) : NULL;
+    if ( lHotReload->mNotify == NULL ) {
+      printf( "Unable to start hot reload! inotify unavailable\n" );
+      return false;
+    }
+  }
+  if ( lHotReload->mMutex == NULL ) {
+    lHotReload->mMutex = SDL_CreateMutex();
+    if ( lHotReload->mMutex == NULL ) {
+      printf( "Unable to create hot reload mutex! SDL Error: %s\n",
+              SDL_GetError() );
+      return false;
+    }
+  }
+  if ( lHotReload->mThread == NULL ) {
+    SDL_AtomicSet( &lHotReload->mQuit, 0 );
+    lHotReload->mThread =
+        SDL_CreateThread( LHotReloadThread, "LHotReload", lHotReload );
+    if ( lHotReload->mThread == NULL ) {
+      printf( "Unable to start hot reload thread! SDL Error: %s\n",
+              SDL_GetError() );
+      return false;
+    }
+  }
+  return true;
+#else
+  (void)lHotReload;
+  printf( "Unable to start hot reload! Requires Linux inotify\n" );
+  return false;
+#endif
+}
+
+bool LHotReloadWatchTexture( LHotReload* lHotReload, LTexture* lTexture,
+                             const char* path, LHotReloadCallback callback,
+                             void* userData ) {
+#ifdef __linux__
+  if ( lHotReload->mNotify == NULL && !LHotReloadStart( lHotReload ) ) {
+    return false;
+  }
+  if ( lHotReload->mWatchCount == LHOT_RELOAD_MAX_WATCHES ) {
+    printf( "Unable to watch %s! Too many watches\n", path );
+    return false;
+  }
+
+  // Watch directory so editors that save by renaming are noticed too
+  char* copy = (char*)malloc( strlen( path ) + 1 );
+  if ( copy == NULL ) {
+    printf( "Unable to allocate watch!\n" );
+    return false;
+  }
+  strcpy( copy, path );
+  char* slash = strrchr( copy, '/' );
+  const char* directory = ".";
+  if ( slash != NULL ) {
+    *slash = '\0';
+    directory = copy;
+  }
+  int wd = inotify_add_watch( fileno( lHotReload->mNotify ), directory,
+                              IN_CLOSE_WRITE | IN_MOVED_TO );
+  if ( slash != NULL ) {
+    *slash = '/';
+  }
+  if ( wd < 0 ) {
+    printf( "Unable to watch %s!\n", path );
+    free( copy );
+    return false;
+  }
+
+  SDL_LockMutex( lHotReload->mMutex );
+  LHotReloadWatch* watch = &lHotReload->mWatches[lHotReload->mWatchCount];
+  memset( watch, 0, sizeof( LHotReloadWatch ) );
+  watch->mPath = copy;
+  watch->mName = slash != NULL ? slash + 1 : copy;
+  watch->mDirectory = wd;
+  watch->mTexture = lTexture;
+  watch->mCallback = callback;
+  watch->mUserData = userData;
+  ++lHotReload->mWatchCount;
+  SDL_UnlockMutex( lHotReload->mMutex );
+  return true;
+#else
+  (void)lHotReload;
+  (void)lTexture;
+  (void)path;
+  (void)callback;
+  (void)userData;
+  return false;
+#endif
+}
+
+void LHotReloadPoll( LHotReload* lHotReload, SDL_Renderer* gRenderer ) {
+  if ( lHotReload->mMutex == NULL ) {
+    return;
+  }
+
+  for ( int i = 0; i < lHotReload->mWatchCount; ++i ) {
+    LHotReloadWatch* watch = &lHotReload->mWatches[i];
+
+    // Take finished reload
+    SDL_LockMutex( lHotReload->mMutex );
+    bool changed = watch->mChanged;
+    SDL_Surface* decoded = watch->mPending;
+    watch->mChanged = false;
+    watch->mPending = NULL;
+    SDL_UnlockMutex( lHotReload->mMutex );
+    if ( !changed ) {
+      continue;
+    }
+
+    // Swap new texture into existing handle, keeping its modulation
+    if ( decoded != NULL ) {
+      LTraceBeginDetail( "LHotReloadUpload", watch->mPath );
+      SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "0" );
+      SDL_Texture* newTexture =
+          SDL_CreateTextureFromSurface( gRenderer, decoded );
+      if ( newTexture == NULL ) {
+        printf( "Unable to create texture from %s! SDL Error: %s\n",
+                watch->mPath, SDL_GetError() );
+      } else {
+        SDL_Texture* oldTexture = watch->mTexture->mTexture;
+        if ( oldTexture != NULL ) {
+          Uint8 r, g, b, a;
+          SDL_BlendMode blending;
+          SDL_GetTextureColorMod( oldTexture, &r, &g, &b );
+          SDL_GetTextureAlphaMod( oldTexture, &a );
+          SDL_GetTextureBlendMode( oldTexture, &blending );
+          SDL_SetTextureColorMod( newTexture, r, g, b );
+          SDL_SetTextureAlphaMod( newTexture, a );
+          SDL_SetTextureBlendMode( newTexture, blending );
+          SDL_DestroyTexture( oldTexture );
+        }
+        // Variants were drawn from the old image, draws fall back to general
+        // rotation until the callback caches them again
+        LTextureFreeVariants( watch->mTexture );
+        watch->mTexture->mTexture = newTexture;
+        watch->mTexture->mWidth = decoded->w;
+        watch->mTexture->mHeight = decoded->h;
+        printf( "Reloaded %s\n", watch->mPath );
+      }
+      LTraceEnd();
+    }
+    SDL_FreeSurface( decoded );
+
+    if ( watch->mCallback != NULL ) {
+      watch->mCallback( watch->mPath, watch->mUserData );
+    }
+  }
+}
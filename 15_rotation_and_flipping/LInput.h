@@ -0,0 +1,184 @@
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Slots in the input ring, must be a power of two
+#define LINPUT_QUEUE_SIZE 256
+
+// Translated input event kinds
+typedef enum LInputType {
+  LINPUT_QUIT,
+  LINPUT_KEY_DOWN,
+  LINPUT_KEY_UP,
+  LINPUT_MOUSE_MOTION,
+  LINPUT_MOUSE_BUTTON_DOWN,
+  LINPUT_MOUSE_BUTTON_UP,
+  LINPUT_TARGETS_RESET
+} LInputType;
+
+// Input event handed from the event pump to the main loop
+typedef struct LInputEvent LInputEvent;
+
+// Event pump feeding a ring of translated events
+// SDL only allows pumping events on the video thread, so the main loop pumps
+// and translates them in one pass right before draining, merging consecutive
+// mouse motion. Handing translation to another thread would only delay this
+// frame's input to the next one. Events the main loop doesn't take stay in
+// the ring for the next frame
+typedef struct LInput LInput;
+
+// creates LInput with default values
+LInput LInputNew( void );
+
+// Reports events dropped while the ring was full
+void LInputFree( LInput* lInput );
+
+// Pumps and translates events, call from the main thread
+void LInputPump( LInput* lInput );
+
+// Takes at most maxEvents queued events, returns how many were taken
+int LInputDrain( LInput* lInput, LInputEvent* events, int maxEvents );
+
+typedef struct LInputEvent {
+  LInputType type;
+
+  // SDL timestamp of the newest merged event
+  Uint32 timestamp;
+
+  // Key for key events
+  SDL_Keycode key;
+
+  // Mouse position, accumulated motion and button
+  int x;
+  int y;
+  int dx;
+  int dy;
+  Uint8 button;
+} LInputEvent;
+
+typedef struct LInput {
+  // Ring slots holding events between head and tail
+  LInputEvent mQueue[LINPUT_QUEUE_SIZE];
+
+  // Next slot to read and next slot to write
+  int mHead;
+  int mTail;
+
+  // Mouse motion held back so following motion can merge into it
+  LInputEvent mMotion;
+  bool mHasMotion;
+
+  // Events dropped because the main loop fell too far behind
+  Uint64 mDropped;
+} LInput;
+
+LInput LInputNew() {
+  LInput lInput;
+  memset( &lInput, 0, sizeof( lInput ) );
+  return lInput;
+}
+
+// Queues event, returns false when ring is full
+static bool LInputPush( LInput* lInput, const LInputEvent* event ) {
+  if ( lInput->mTail - lInput->mHead == LINPUT_QUEUE_SIZE ) {
+    return false;
+  }
+  lInput->mQueue[lInput->mTail & ( LINPUT_QUEUE_SIZE - 1 )] = *event;
+  ++lInput->mTail;
+  return true;
+}
+
+// Pushes held back motion
+static void LInputFlushMotion( LInput* lInput ) {
+  if ( lInput->mHasMotion && LInputPush( lInput, &lInput->mMotion ) ) {
+    lInput->mHasMotion = false;
+  }
+}
+
+// Translates SDL event and queues it
+static void LInputTranslate( LInput* lInput, const SDL_Event* e ) {
+  LInputEvent event;
+  memset( &event, 0, sizeof( event ) );
+  event.timestamp = e->common.timestamp;
+
+  switch ( e->type ) {
+  case SDL_QUIT:
+    event.type = LINPUT_QUIT;
+    break;
+
+  case SDL_KEYDOWN:
+  case SDL_KEYUP:
+    event.type = e->type == SDL_KEYDOWN ? LINPUT_KEY_DOWN : LINPUT_KEY_UP;
+    event.key = e->key.keysym.sym;
+    break;
+
+  case SDL_MOUSEMOTION:
+    // Merge into held back motion, it is published before the next event
+    if ( !lInput->mHasMotion ) {
+      lInput->mMotion = event;
+      lInput->mMotion.type = LINPUT_MOUSE_MOTION;
+      lInput->mHasMotion = true;
+    }
+    lInput->mMotion.timestamp = e->motion.timestamp;
+    lInput->mMotion.x = e->motion.x;
+    lInput->mMotion.y = e->motion.y;
+    lInput->mMotion.dx += e->motion.xrel;
+    lInput->mMotion.dy += e->motion.yrel;
+    return;
+
+  case SDL_MOUSEBUTTONDOWN:
+  case SDL_MOUSEBUTTONUP:
+    event.type = e->type == SDL_MOUSEBUTTONDOWN ? LINPUT_MOUSE_BUTTON_DOWN
+                                                : LINPUT_MOUSE_BUTTON_UP;
+    event.x = e->button.x;
+    event.y = e->button.y;
+    event.button = e->button.button;
+    break;
+
+  case SDL_RENDER_TARGETS_RESET:
+    event.type = LINPUT_TARGETS_RESET;
+    break;
+
+  default:
+    return;
+  }
+
+  // Keep ordering with motion that came before
+  LInputFlushMotion( lInput );
+  if ( lInput->mHasMotion || !LInputPush( lInput, &event ) ) {
+    ++lInput->mDropped;
+  }
+}
+
+void LInputPump( LInput* lInput ) {
+  SDL_PumpEvents();
+  SDL_Event e;
+  while ( SDL_PeepEvents( &e, 1, SDL_GETEVENT, SDL_FIRSTEVENT,
+                          SDL_LASTEVENT ) > 0 ) {
+    LInputTranslate( lInput, &e );
+  }
+  LInputFlushMotion( lInput );
+}
+
+void LInputFree( LInput* lInput ) {
+  if ( lInput->mDropped > 0 ) {
+    printf( "Input queue dropped %llu events\n",
+            (unsigned long long)lInput->mDropped );
+  }
+  *lInput = LInputNew();
+}
+
+int LInputDrain( LInput* lInput, LInputEvent* events, int maxEvents ) {
+  // Take this frame's events as well as ones left from earlier frames
+  LInputPump( lInput );
+
+  int count = 0;
+  while ( lInput->mHead != lInput->mTail && count < maxEvents ) {
+    events[count++] =
+        lInput->mQueue[lInput->mHead & ( LINPUT_QUEUE_SIZE - 1 )];
+    ++lInput->mHead;
+  }
+  return count;
+}
@@ -1,7 +1,15 @@
+#ifndef LTEXTURE_H
+#define LTEXTURE_H
+
 #include <SDL2/SDL.h>
 #include <SDL2_Image/SDL_image.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+
+// Precomputed rotated/flipped copy of a texture inside the variant atlas
+typedef struct LTextureVariant LTextureVariant;
 
 // Texture wrapper struct
 typedef struct LTexture LTexture;
@@ -16,6 +24,12 @@ void LTextureFree( LTexture* lTexture );
 bool LTextureLoadFromFile( LTexture* lTexture, SDL_Renderer* gRenderer,
                            char* path );
 
+// Prerenders every combination of given angles and flips into one atlas
+// Whole texture draws around the default center then become plain copies
+bool LTextureCacheVariants( LTexture* lTexture, SDL_Renderer* gRenderer,
+                            const double* angles, int angleCount,
+                            const SDL_RendererFlip* flips, int flipCount );
+
 // Renders texture at given point
 void LTextureRender( LTexture* lTexture, SDL_Renderer* gRenderer, int x, int y,
                      SDL_Rect* clip, double angle, SDL_Point* center,
@@ -30,6 +44,15 @@ void LTextureSetBlendMode( LTexture* lTexture, SDL_BlendMode blending );
 // Set alpha modulation
 void LTextureSetAlpha( LTexture* lTexture, Uint8 alpha );
 
+typedef struct LTextureVariant {
+  // Rotation in degrees within [0, 360) and flip this variant was drawn with
+  double angle;
+  SDL_RendererFlip flip;
+
+  // Cell in atlas, centered on the texture's center
+  SDL_Rect rect;
+} LTextureVariant;
+
 typedef struct LTexture {
   // The actual hardware texture
   SDL_Texture* mTexture;
@@ -37,14 +60,31 @@ typedef struct LTexture {
   // Image dimensions
   int mWidth;
   int mHeight;
+
+  // Atlas of precomputed rotated/flipped variants
+  SDL_Texture* mVariantAtlas;
+  LTextureVariant* mVariants;
+  int mVariantCount;
 } LTexture;
 
 LTexture LTextureNew() {
-  LTexture lTexture = { NULL, 0, 0 };
+  LTexture lTexture = { NULL, 0, 0, NULL, NULL, 0 };
   return lTexture;
 }
 
+// Deallocates variant atlas only
+static void LTextureFreeVariants( LTexture* lTexture ) {
+  if ( lTexture->mVariantAtlas != NULL ) {
+    SDL_DestroyTexture( lTexture->mVariantAtlas );
+    lTexture->mVariantAtlas = NULL;
+  }
+  free( lTexture->mVariants );
+  lTexture->mVariants = NULL;
+  lTexture->mVariantCount = 0;
+}
+
 void LTextureFree( LTexture* lTexture ) {
+  LTextureFreeVariants( lTexture );
   if ( lTexture->mTexture != NULL ) {
     SDL_DestroyTexture( lTexture->mTexture );
     lTexture->mTexture = NULL;
@@ -100,9 +140,152 @@ bool LTextureLoadFromFile( LTexture* lTexture, SDL_Renderer* gRenderer,
   return true;
 }
 
+// Maps any angle in degrees into [0, 360)
+static double LTextureNormalizeAngle( double angle ) {
+  angle = fmod( angle, 360.0 );
+  if ( angle < 0 ) {
+    angle += 360.0;
+  }
+  return angle;
+}
+
+// Finds precomputed variant for angle and flip, NULL if none was cached
+static LTextureVariant* LTextureFindVariant( LTexture* lTexture, double angle,
+                                             SDL_RendererFlip flip ) {
+  angle = LTextureNormalizeAngle( angle );
+  for ( int i = 0; i < lTexture->mVariantCount; ++i ) {
+    LTextureVariant* variant = &lTexture->mVariants[i];
+    double delta = fabs( variant->angle - angle );
+    if ( variant->flip == flip && ( delta < 1e-6 || 360.0 - delta < 1e-6 ) ) {
+      return variant;
+    }
+  }
+  return NULL;
+}
+
+bool LTextureCacheVariants( LTexture* lTexture, SDL_Renderer* gRenderer,
+                            const double* angles, int angleCount,
+                            const SDL_RendererFlip* flips, int flipCount ) {
+  // Get rid of preexisting atlas
+  LTextureFreeVariants( lTexture );
+
+  int count = angleCount * flipCount;
+  if ( lTexture->mTexture == NULL || count <= 0 ) {
+    return false;
+  }
+  if ( !SDL_RenderTargetSupported( gRenderer ) ) {
+    printf( "Unable to cache texture variants! Render targets unsupported\n" );
+    return false;
+  }
+
+  // Find the largest rotated bounding box so every variant fits one cell
+  int w = lTexture->mWidth;
+  int h = lTexture->mHeight;
+  double maxWidth = w;
+  double maxHeight = h;
+  for ( int i = 0; i < angleCount; ++i ) {
+    double radians = LTextureNormalizeAngle( angles[i] ) * M_PI / 180.0;
+    double c = fabs( cos( radians ) );
+    double s = fabs( sin( radians ) );
+    maxWidth = fmax( maxWidth, w * c + h * s );
+    maxHeight = fmax( maxHeight, w * s + h * c );
+  }
+
+  // Pad evenly on both sides so cell centers land on texture centers
+  int padX = (int)ceil( ( maxWidth - w ) / 2 ) + 1;
+  int padY = (int)ceil( ( maxHeight - h ) / 2 ) + 1;
+  int cellWidth = w + 2 * padX;
+  int cellHeight = h + 2 * padY;
+
+  // Lay cells out in a roughly square grid
+  int columns = (int)ceil( sqrt( (double)count ) );
+  int rows = ( count + columns - 1 ) / columns;
+
+  lTexture->mVariants =
+      (LTextureVariant*)malloc( sizeof( LTextureVariant ) * (size_t)count );
+  if ( lTexture->mVariants == NULL ) {
+    printf( "Unable to allocate texture variants!\n" );
+    return false;
+  }
+
+  lTexture->mVariantAtlas = SDL_CreateTexture(
+      gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+      columns * cellWidth, rows * cellHeight );
+  if ( lTexture->mVariantAtlas == NULL ) {
+    printf( "Unable to create variant atlas! SDL Error: %s\n",
+            SDL_GetError() );
+    LTextureFreeVariants( lTexture );
+    return false;
+  }
+
+  // Atlas draws must look like draws of the source texture
+  Uint8 r, g, b, a;
+  SDL_BlendMode blending;
+  SDL_GetTextureColorMod( lTexture->mTexture, &r, &g, &b );
+  SDL_GetTextureAlphaMod( lTexture->mTexture, &a );
+  SDL_GetTextureBlendMode( lTexture->mTexture, &blending );
+  SDL_SetTextureColorMod( lTexture->mVariantAtlas, r, g, b );
+  SDL_SetTextureAlphaMod( lTexture->mVariantAtlas, a );
+  SDL_SetTextureBlendMode( lTexture->mVariantAtlas, blending );
+
+  // Copy variants unmodulated and unblended into transparent atlas, cells
+  // don't overlap so the atlas holds the source texels as they are and alpha
+  // is only applied once, when the atlas is drawn
+  SDL_Texture* previousTarget = SDL_GetRenderTarget( gRenderer );
+  Uint8 drawR, drawG, drawB, drawA;
+  SDL_GetRenderDrawColor( gRenderer, &drawR, &drawG, &drawB, &drawA );
+  SDL_SetRenderTarget( gRenderer, lTexture->mVariantAtlas );
+  SDL_SetRenderDrawColor( gRenderer, 0, 0, 0, 0 );
+  SDL_RenderClear( gRenderer );
+  SDL_SetTextureColorMod( lTexture->mTexture, 0xFF, 0xFF, 0xFF );
+  SDL_SetTextureAlphaMod( lTexture->mTexture, 0xFF );
+  SDL_SetTextureBlendMode( lTexture->mTexture, SDL_BLENDMODE_NONE );
+
+  for ( int i = 0; i < count; ++i ) {
+    LTextureVariant* variant = &lTexture->mVariants[i];
+    variant->angle = LTextureNormalizeAngle( angles[i / flipCount] );
+    variant->flip = flips[i % flipCount];
+    variant->rect.x = ( i % columns ) * cellWidth;
+    variant->rect.y = ( i / columns ) * cellHeight;
+    variant->rect.w = cellWidth;
+    variant->rect.h = cellHeight;
+
+    SDL_Rect renderQuad = { variant->rect.x + padX, variant->rect.y + padY, w,
+                            h };
+    SDL_RenderCopyEx( gRenderer, lTexture->mTexture, NULL, &renderQuad,
+                      variant->angle, NULL, variant->flip );
+  }
+  lTexture->mVariantCount = count;
+
+  // Restore renderer and texture state
+  SDL_SetRenderTarget( gRenderer, previousTarget );
+  SDL_SetRenderDrawColor( gRenderer, drawR, drawG, drawB, drawA );
+  SDL_SetTextureColorMod( lTexture->mTexture, r, g, b );
+  SDL_SetTextureAlphaMod( lTexture->mTexture, a );
+  SDL_SetTextureBlendMode( lTexture->mTexture, blending );
+
+  return true;
+}
+
 void LTextureRender( LTexture* lTexture, SDL_Renderer* gRenderer, int x, int y,
                      SDL_Rect* clip, double angle, SDL_Point* center,
                      SDL_RendererFlip flip ) {
+  // Use precomputed variant for whole texture draws around default center
+  if ( clip == NULL && center == NULL && lTexture->mVariantCount > 0 ) {
+    LTextureVariant* variant = LTextureFindVariant( lTexture, angle, flip );
+    if ( variant != NULL ) {
+      SDL_Rect variantQuad = {
+          x - ( variant->rect.w - lTexture->mWidth ) / 2,
+          y - ( variant->rect.h - lTexture->mHeight ) / 2, variant->rect.w,
+          variant->rect.h };
+      if ( SDL_RenderCopy( gRenderer, lTexture->mVariantAtlas, &variant->rect,
+                           &variantQuad ) != 0 ) {
+        printf( "Failed to render texture! SDL Error: %s\n", SDL_GetError() );
+      }
+      return;
+    }
+  }
+
   // Set rendering space and render to screen
   SDL_Rect renderQuad = { x, y, lTexture->mWidth, lTexture->mHeight };
 
@@ -126,13 +309,24 @@ bool LTextureSetColor( LTexture* lTexture, Uint8 red, Uint8 green,
     printf( "Failed to set color modulation! SDL Error: %s\n", SDL_GetError() );
     return false;
   }
+  if ( lTexture->mVariantAtlas != NULL ) {
+    SDL_SetTextureColorMod( lTexture->mVariantAtlas, red, green, blue );
+  }
   return true;
 }
 
 void LTextureSetBlendMode( LTexture* lTexture, SDL_BlendMode blending ) {
   SDL_SetTextureBlendMode( lTexture->mTexture, blending );
+  if ( lTexture->mVariantAtlas != NULL ) {
+    SDL_SetTextureBlendMode( lTexture->mVariantAtlas, blending );
+  }
 }
 
 void LTextureSetAlpha( LTexture* lTexture, Uint8 alpha ) {
   SDL_SetTextureAlphaMod( lTexture->mTexture, alpha );
-}
\ No newline at end of file
+  if ( lTexture->mVariantAtlas != NULL ) {
+    SDL_SetTextureAlphaMod( lTexture->mVariantAtlas, alpha );
+  }
+}
+
+#endif
@@ -3,11 +3,32 @@ and may not be redistributed without written permission.*/
 
 // Using SDL, SDL_image, SDL_ttf, standard IO, math, and strings
 #include "LTexture.h"
+#include "LFontRegistry.h"
+#include "LLayer.h"
+#include "LMemory.h"
+#include "LMetrics.h"
+#include "LSDFFont.h"
+#include "LTextCache.h"
+#include "LTextLabel.h"
+#include "LTrace.h"
 
 // Screen dimension constants
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+// Font point size
+const int FONT_SIZE = 28;
+
+// Size the distance field atlas is built at and its range in pixels
+const int SDF_BASE_SIZE = 48;
+const int SDF_SPREAD = 6;
+
+// Texture memory rendered text may hold
+const size_t TEXT_CACHE_BUDGET = 4 * 1024 * 1024;
+
+// Idle staging memory kept for later uploads once loading is done
+const size_t STAGING_IDLE_BUDGET = 1024 * 1024;
+
 // Starts up SDL and creates window
 bool init( void );
 
@@ -17,22 +38,68 @@ bool loadMedia( void );
 // Frees media and shuts down SDL
 void close( void );
 
+// Looks up rendered text, rasterizing it only on first use
+LTexture* getTextTexture( void );
+
+// Evaluates zoomable label at current zoom from the distance field atlas
+bool renderZoomText( void );
+
+// Starts publishing metrics, on by default since it costs a store per value
+void startMetrics( void );
+
+// Records this frame's metrics
+void updateMetrics( void );
+
 // The window we'll be rendering to
 SDL_Window* gWindow = NULL;
 
 // The window renderer
 SDL_Renderer* gRenderer = NULL;
 
+// Opened fonts sharing one mapping per file
+LFontRegistry gFontRegistry;
+
 // Globally used font
 TTF_Font* gFont = NULL;
 
-// Rendered texture
-LTexture gTextTexture;
+// Rendered text textures
+LTextCache gTextCache;
+
+// Displayed text
+const char* gText = "The quick brown fox jumps over the lazy dog";
+const SDL_Color gTextColor = { 0, 0, 0, 0xFF };
+
+// Distance field glyphs for zoomable text
+LSDFFont gSDFFont;
+
+// Zoomable label and its height in pixels
+LTexture gZoomTexture;
+int gZoomHeight = 28;
+
+// Frame counter that only re-renders changed digits
+LTextLabel gFrameLabel;
+
+// Metrics published for my_metrics_tail and their ids
+LMetrics gMetrics;
+int gDrawsMetric = -1;
+int gTextCacheHitsMetric = -1;
+int gTextCacheMissesMetric = -1;
+int gTextCacheBytesMetric = -1;
+int gTextureBytesMetric = -1;
+int gSurfaceBytesMetric = -1;
+
+// Cached layer holding the static text
+LLayer gTextLayer;
 
 bool init() {
   // Initialization flag
   bool success = true;
 
+  // Record a timeline when LTRACE_FILE is set
+  if ( LTraceInit() ) {
+    LTraceThreadName( "main" );
+  }
+
   // Initialize SDL
   if ( SDL_Init( SDL_INIT_VIDEO ) < 0 ) {
     printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
@@ -51,9 +118,11 @@ bool init() {
       printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
       success = false;
     } else {
-      // Create vsynced renderer for window
-      gRenderer = SDL_CreateRenderer(
-          gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+      // Create vsynced renderer for window that can render to textures
+      gRenderer = SDL_CreateRenderer( gWindow, -1,
+                                      SDL_RENDERER_ACCELERATED |
+                                          SDL_RENDERER_PRESENTVSYNC |
+                                          SDL_RENDERER_TARGETTEXTURE );
       if ( gRenderer == NULL ) {
         printf( "Renderer could not be created! SDL Error: %s\n",
                 SDL_GetError() );
@@ -88,30 +157,68 @@ bool loadMedia() {
   bool success = true;
 
   // Open the font
-  gFont = TTF_OpenFont( "16_true_type_fonts/lazy.ttf", 28 );
+  gFont = LFontRegistryGet( &gFontRegistry, "16_true_type_fonts/lazy.ttf",
+                            FONT_SIZE );
   if ( gFont == NULL ) {
     printf( "Failed to load lazy font! SDL_ttf Error: %s\n", TTF_GetError() );
     success = false;
   } else {
     // Render text
-    SDL_Color textColor = { 0, 0, 0, 0xFF };
-    if ( !LTextureLoadFromRenderedText(
-             &gTextTexture, gRenderer, gFont,
-             "The quick brown fox jumps over the lazy dog", textColor ) ) {
+    gTextCache = LTextCacheNew( TEXT_CACHE_BUDGET );
+    LTexture* textTexture = getTextTexture();
+    if ( textTexture == NULL ) {
       printf( "Failed to render text texture!\n" );
       success = false;
+    } else if ( !LLayerCreate( &gTextLayer, gRenderer, textTexture->mWidth,
+                               textTexture->mHeight ) ) {
+      printf( "Failed to create text layer!\n" );
+      success = false;
     }
   }
 
+  // Build distance field atlas once from a large rasterization
+  TTF_Font* sdfFont = LFontRegistryGet(
+      &gFontRegistry, "16_true_type_fonts/lazy.ttf", SDF_BASE_SIZE );
+  if ( sdfFont == NULL ) {
+    printf( "Failed to load lazy font! SDL_ttf Error: %s\n", TTF_GetError() );
+    success = false;
+  } else {
+    LTraceBegin( "LSDFFontBuild" );
+    bool built = LSDFFontBuild( &gSDFFont, sdfFont, SDF_SPREAD );
+    LTraceEnd();
+    if ( !built || !renderZoomText() ) {
+      printf( "Failed to render distance field text!\n" );
+      success = false;
+    }
+  }
+
+  // Loading staged the largest surfaces, text rendered later needs less
+  LTextureTrimStaging( STAGING_IDLE_BUDGET );
+
   return success;
 }
 
 void close() {
+  // Stop publishing metrics
+  LMetricsFree( &gMetrics );
+
+  // Report what was held and the peaks reached
+  LMemoryDump();
+
   // Free loaded images
-  LTextureFree( &gTextTexture );
+  LTextCachePrintStats( &gTextCache );
+  LTextCacheFree( &gTextCache );
+  LLayerFree( &gTextLayer );
+  LTextureFree( &gZoomTexture );
+  LSDFFontFree( &gSDFFont );
+  printf( "Frame label uploaded %llu pixels\n",
+          (unsigned long long)gFrameLabel.mUploadedPixels );
+  LTextLabelFree( &gFrameLabel );
+  LTexturePrintStagingStats();
+  LTextureFreeStaging();
 
-  // Free global font
-  TTF_CloseFont( gFont );
+  // Free global fonts
+  LFontRegistryFree( &gFontRegistry );
   gFont = NULL;
 
   // Destroy window
@@ -120,12 +227,64 @@ void close() {
   gWindow = NULL;
   gRenderer = NULL;
 
+  // Write timeline
+  LTraceFlush();
+
   // Quit SDL subsystems
   TTF_Quit();
   IMG_Quit();
   SDL_Quit();
 }
 
+LTexture* getTextTexture() {
+  return LTextCacheGet( &gTextCache, gRenderer, gFont, FONT_SIZE, gText,
+                        gTextColor, LTEXT_RENDER_SOLID );
+}
+
+bool renderZoomText() {
+  LSDFStyle style = { 2, { 0xFF, 0xC0, 0x00, 0xFF }, 3, 3,
+                      { 0, 0, 0, 0x60 } };
+  return LSDFFontRenderText( &gSDFFont, &gZoomTexture, gRenderer,
+                             "Scroll to zoom", gZoomHeight, gTextColor,
+                             &style );
+}
+
+void startMetrics() {
+  gMetrics = LMetricsNew();
+  gDrawsMetric = LMetricsRegister( &gMetrics, "draws", LMETRIC_COUNTER );
+  gTextCacheHitsMetric =
+      LMetricsRegister( &gMetrics, "text_cache_hits", LMETRIC_COUNTER );
+  gTextCacheMissesMetric =
+      LMetricsRegister( &gMetrics, "text_cache_misses", LMETRIC_COUNTER );
+  gTextCacheBytesMetric =
+      LMetricsRegister( &gMetrics, "text_cache_bytes", LMETRIC_GAUGE );
+  gTextureBytesMetric =
+      LMetricsRegister( &gMetrics, "texture_bytes", LMETRIC_GAUGE );
+  gSurfaceBytesMetric =
+      LMetricsRegister( &gMetrics, "surface_bytes", LMETRIC_GAUGE );
+
+  // Socket path can be moved with LMETRICS_SOCKET
+  const char* path = SDL_getenv( "LMETRICS_SOCKET" );
+  if ( !LMetricsStart( &gMetrics,
+                       path != NULL ? path : LMETRICS_DEFAULT_SOCKET ) ) {
+    printf( "Warning: Metrics not published!\n" );
+  }
+}
+
+void updateMetrics() {
+  LMetricsSet( &gMetrics, gDrawsMetric,
+               (double)(Uint32)SDL_AtomicGet( &gLTextureDrawCalls ) );
+  LMetricsSet( &gMetrics, gTextCacheHitsMetric, (double)gTextCache.mHits );
+  LMetricsSet( &gMetrics, gTextCacheMissesMetric,
+               (double)gTextCache.mMisses );
+  LMetricsSet( &gMetrics, gTextCacheBytesMetric, (double)gTextCache.mBytes );
+  LMetricsSet( &gMetrics, gTextureBytesMetric,
+               (double)LMemoryCurrent( LMEMORY_TEXTURE ) );
+  LMetricsSet( &gMetrics, gSurfaceBytesMetric,
+               (double)LMemoryCurrent( LMEMORY_SURFACE ) );
+  LMetricsFrame( &gMetrics );
+}
+
 int main() {
   // Start up SDL and create window
   if ( !init() ) {
@@ -141,28 +300,85 @@ int main() {
       // Event handler
       SDL_Event e;
 
+      // Frames rendered so far and its text
+      unsigned int frame = 0;
+      char frameText[64];
+
+      // Publish frame time, draws and cache use once per second
+      startMetrics();
+
       // While application is running
       while ( !quit ) {
+        LTraceBegin( "frame" );
+
         // Handle events on queue
+        LTraceBegin( "events" );
         while ( SDL_PollEvent( &e ) != 0 ) {
           // User requests quit
           if ( e.type == SDL_QUIT ) {
             quit = true;
           }
+          // Target textures lost their contents
+          else if ( e.type == SDL_RENDER_TARGETS_RESET ) {
+            LLayerInvalidate( &gTextLayer );
+          }
+          // Zoom label without rasterizing glyphs again
+          else if ( e.type == SDL_MOUSEWHEEL ) {
+            gZoomHeight = SDL_max( 8, SDL_min( gZoomHeight + e.wheel.y * 4,
+                                               SCREEN_HEIGHT / 2 ) );
+            renderZoomText();
+          }
+          // Print memory held in textures and surfaces
+          else if ( e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_m ) {
+            LMemoryDump();
+            LTexturePrintStagingStats();
+          }
         }
+        LTraceEnd();
 
         // Clear screen
+        LTraceBegin( "SDL_RenderClear" );
         SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
         SDL_RenderClear( gRenderer );
+        LTraceEnd();
+
+        // Draw text into its layer only when invalidated
+        LTraceBegin( "render" );
+        if ( LLayerBegin( &gTextLayer, gRenderer ) ) {
+          LTexture* textTexture = getTextTexture();
+          if ( textTexture != NULL ) {
+            LTextureRender( textTexture, gRenderer, 0, 0, NULL, 0, NULL,
+                            SDL_FLIP_NONE );
+          }
+          LLayerEnd( &gTextLayer, gRenderer );
+        }
 
         // Render current frame
-        LTextureRender( &gTextTexture, gRenderer,
-                        ( SCREEN_WIDTH - gTextTexture.mWidth ) / 2,
-                        ( SCREEN_HEIGHT - gTextTexture.mHeight ) / 2, NULL, 0,
+        LLayerRender( &gTextLayer, gRenderer,
+                      ( SCREEN_WIDTH - gTextLayer.mWidth ) / 2,
+                      ( SCREEN_HEIGHT - gTextLayer.mHeight ) / 2 );
+        LTextureRender( &gZoomTexture, gRenderer,
+                        ( SCREEN_WIDTH - gZoomTexture.mWidth ) / 2,
+                        ( SCREEN_HEIGHT + gTextLayer.mHeight ) / 2, NULL, 0,
                         NULL, SDL_FLIP_NONE );
 
+        LTraceEnd();
+
+        // Update frame counter
+        LTraceBegin( "update label" );
+        snprintf( frameText, sizeof( frameText ), "Frame %u", frame++ );
+        LTextLabelSetText( &gFrameLabel, gRenderer, gFont, frameText,
+                           gTextColor );
+        LTextLabelRender( &gFrameLabel, gRenderer, 10, 10 );
+        LTraceEnd();
+
         // Update screen
+        LTraceBegin( "SDL_RenderPresent" );
         SDL_RenderPresent( gRenderer );
+        LTraceEnd();
+        updateMetrics();
+
+        LTraceEnd();
       }
     }
   }
@@ -0,0 +1,188 @@
+#include <SDL2/SDL.h>
+#include <SDL2_ttf/SDL_ttf.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Font file mapped into memory once
+typedef struct LFontFile LFontFile;
+
+// Opened size of a registered font file
+typedef struct LFontEntry LFontEntry;
+
+// Registry handing out one TTF_Font per (file, point size)
+// Every size of a file is opened over the same read only mapping, so adding
+// sizes doesn't copy the file again and reopening a size is a lookup
+typedef struct LFontRegistry LFontRegistry;
+
+// creates empty LFontRegistry
+LFontRegistry LFontRegistryNew( void );
+
+// Closes all fonts and unmaps their files
+void LFontRegistryFree( LFontRegistry* lFontRegistry );
+
+// Returns font at path opened at point size, owned by the registry
+TTF_Font* LFontRegistryGet( LFontRegistry* lFontRegistry, const char* path,
+                            int ptsize );
+
+typedef struct LFontFile {
+  char* mPath;
+
+  // File contents, mapped where possible
+  void* mData;
+  size_t mSize;
+  bool mMapped;
+} LFontFile;
+
+typedef struct LFontEntry {
+  // Index of file in registry
+  int mFile;
+  int mPtsize;
+  TTF_Font* mFont;
+} LFontEntry;
+
+typedef struct LFontRegistry {
+  LFontFile* mFiles;
+  int mFileCount;
+
+  LFontEntry* mFonts;
+  int mFontCount;
+} LFontRegistry;
+
+LFontRegistry LFontRegistryNew() {
+  LFontRegistry lFontRegistry = { NULL, 0, NULL, 0 };
+  return lFontRegistry;
+}
+
+void LFontRegistryFree( LFontRegistry* lFontRegistry ) {
+  // Fonts read from the mappings, close them first
+  for ( int i = 0; i < lFontRegistry->mFontCount; ++i ) {
+    TTF_CloseFont( lFontRegistry->mFonts[i].mFont );
+  }
+  free( lFontRegistry->mFonts );
+
+  for ( int i = 0; i < lFontRegistry->mFileCount; ++i ) {
+    LFontFile* file = &lFontRegistry->mFiles[i];
+#ifndef _WIN32
+    if ( file->mMapped ) {
+      munmap( file->mData, file->mSize );
+    } else
+#endif
+    {
+      SDL_free( file->mData );
+    }
+    free( file->mPath );
+  }
+  free( lFontRegistry->mFiles );
+
+  *lFontRegistry = LFontRegistryNew();
+}
+
+// Maps font file into memory, falling back to reading it
+static bool LFontRegistryLoadFile( LFontFile* file, const char* path ) {
+  file->mData = NULL;
+  file->mSize = 0;
+  file->mMapped = false;
+
+#ifndef _WIN32
+  FILE* stream = fopen( path, "rb" );
+  if ( stream != NULL ) {
+    struct stat info;
+    if ( fstat( fileno( stream ), &info ) == 0 && info.st_size > 0 ) {
+      void* data = mmap( NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE,
+                         fileno( stream ), 0 );
+      if ( data != MAP_FAILED ) {
+        file->mData = data;
+        file->mSize = (size_t)info.st_size;
+        file->mMapped = true;
+      }
+    }
+
+    // Mapping stays valid after the descriptor is closed
+    fclose( stream );
+  }
+#endif
+
+  if ( file->mData == NULL ) {
+    file->mData = SDL_LoadFile( path, &file->mSize );
+  }
+  if ( file->mData == NULL ) {
+    printf( "Unable to load font file %s! SDL Error: %s\n", path,
+            SDL_GetError() );
+    return false;
+  }
+
+  file->mPath = (char*)malloc( strlen( path ) + 1 );
+  if ( file->mPath == NULL ) {
+    printf( "Unable to allocate font file path!\n" );
+    return false;
+  }
+  strcpy( file->mPath, path );
+  return true;
+}
+
+TTF_Font* LFontRegistryGet( LFontRegistry* lFontRegistry, const char* path,
+                            int ptsize ) {
+  // Find mapped file
+  int fileIndex = -1;
+  for ( int i = 0; i < lFontRegistry->mFileCount; ++i ) {
+    if ( strcmp( lFontRegistry->mFiles[i].mPath, path ) == 0 ) {
+      fileIndex = i;
+      break;
+    }
+  }
+
+  // Reuse size opened before
+  for ( int i = 0; fileIndex >= 0 && i < lFontRegistry->mFontCount; ++i ) {
+    LFontEntry* entry = &lFontRegistry->mFonts[i];
+    if ( entry->mFile == fileIndex && entry->mPtsize == ptsize ) {
+      return entry->mFont;
+    }
+  }
+
+  // Map file on first use
+  if ( fileIndex < 0 ) {
+    LFontFile* files = (LFontFile*)realloc(
+        lFontRegistry->mFiles,
+        sizeof( LFontFile ) * (size_t)( lFontRegistry->mFileCount + 1 ) );
+    if ( files == NULL ) {
+      printf( "Unable to allocate font file!\n" );
+      return NULL;
+    }
+    lFontRegistry->mFiles = files;
+    if ( !LFontRegistryLoadFile( &files[lFontRegistry->mFileCount], path ) ) {
+      return NULL;
+    }
+    fileIndex = lFontRegistry->mFileCount++;
+  }
+
+  // Open size over the shared mapping
+  LFontEntry* fonts = (LFontEntry*)realloc(
+      lFontRegistry->mFonts,
+      sizeof( LFontEntry ) * (size_t)( lFontRegistry->mFontCount + 1 ) );
+  if ( fonts == NULL ) {
+    printf( "Unable to allocate font entry!\n" );
+    return NULL;
+  }
+  lFontRegistry->mFonts = fonts;
+
+  LFontFile* file = &lFontRegistry->mFiles[fileIndex];
+  SDL_RWops* rw = SDL_RWFromConstMem( file->mData, (int)file->mSize );
+  TTF_Font* font = rw != NULL ? TTF_OpenFontRW( rw, 1, ptsize ) : NULL;
+  if ( font == NULL ) {
+    printf( "Unable to open font %s! SDL_ttf Error: %s\n", path,
+            TTF_GetError() );
+    return NULL;
+  }
+
+  LFontEntry* entry = &fonts[lFontRegistry->mFontCount++];
+  entry->mFile = fileIndex;
+  entry->mPtsize = ptsize;
+  entry->mFont = font;
+  return font;
+}
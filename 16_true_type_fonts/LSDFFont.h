@@ -0,0 +1,470 @@
+#include "LTexture.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Printable ASCII glyphs stored in the atlas
+#define LSDF_FIRST_GLYPH 32
+#define LSDF_GLYPH_COUNT 95
+
+// Width of the distance atlas in texels
+#define LSDF_ATLAS_WIDTH 1024
+
+// Glyph cell inside signed distance atlas
+typedef struct LSDFGlyph LSDFGlyph;
+
+// Signed distance field glyph atlas, built once per font
+// Text of any size, outlined or shadowed, is evaluated from the atlas on the
+// CPU, so zooming never rasterizes glyphs again and works on any renderer
+typedef struct LSDFFont LSDFFont;
+
+// Optional outline and drop shadow
+typedef struct LSDFStyle LSDFStyle;
+
+// creates LSDFFont with default values
+LSDFFont LSDFFontNew( void );
+
+// Deallocates LSDFFont
+void LSDFFontFree( LSDFFont* lSDFFont );
+
+// Rasterizes every glyph of font once and stores distances up to spread
+// pixels from each outline, open the font large (e.g. 48pt) for sharp output
+bool LSDFFontBuild( LSDFFont* lSDFFont, TTF_Font* gFont, int spread );
+
+// Evaluates text at given pixel height into a streaming texture
+// Style may be NULL for plain text
+bool LSDFFontRenderText( LSDFFont* lSDFFont, LTexture* lTexture,
+                         SDL_Renderer* gRenderer, const char* text,
+                         int pixelHeight, SDL_Color textColor,
+                         const LSDFStyle* style );
+
+typedef struct LSDFGlyph {
+  // Distance cell in atlas, glyph bitmap plus spread on every side
+  SDL_Rect mRect;
+
+  // Horizontal pen advance at base size
+  int mAdvance;
+} LSDFGlyph;
+
+typedef struct LSDFFont {
+  // Single channel distances, 128 on the outline and larger inside
+  Uint8* mAtlas;
+  int mAtlasWidth;
+  int mAtlasHeight;
+
+  LSDFGlyph mGlyphs[LSDF_GLYPH_COUNT];
+
+  // Line height and distance range at the size the atlas was built with
+  int mBaseHeight;
+  int mSpread;
+} LSDFFont;
+
+typedef struct LSDFStyle {
+  // Outline thickness in output pixels, 0 for none
+  int mOutline;
+  SDL_Color mOutlineColor;
+
+  // Shadow offset in output pixels, transparent color for none
+  int mShadowX;
+  int mShadowY;
+  SDL_Color mShadowColor;
+} LSDFStyle;
+
+LSDFFont LSDFFontNew() {
+  LSDFFont lSDFFont;
+  memset( &lSDFFont, 0, sizeof( lSDFFont ) );
+  return lSDFFont;
+}
+
+void LSDFFontFree( LSDFFont* lSDFFont ) {
+  free( lSDFFont->mAtlas );
+  *lSDFFont = LSDFFontNew();
+}
+
+// Offset to nearest seed pixel used by the 8SSEDT distance transform
+typedef struct LSDFOffset {
+  int dx;
+  int dy;
+} LSDFOffset;
+
+// Pulls neighbour's nearest seed into p if it is closer
+static void LSDFCompare( LSDFOffset* grid, int w, int h, LSDFOffset* p, int x,
+                         int y, int ox, int oy ) {
+  if ( x + ox < 0 || y + oy < 0 || x + ox >= w || y + oy >= h ) {
+    return;
+  }
+  LSDFOffset other = grid[( y + oy ) * w + x + ox];
+  other.dx += ox;
+  other.dy += oy;
+  if ( other.dx * other.dx + other.dy * other.dy <
+       p->dx * p->dx + p->dy * p->dy ) {
+    *p = other;
+  }
+}
+
+// Two pass 8-point sequential euclidean distance transform
+static void LSDFTransform( LSDFOffset* grid, int w, int h ) {
+  for ( int y = 0; y < h; ++y ) {
+    for ( int x = 0; x < w; ++x ) {
+      LSDFOffset* p = &grid[y * w + x];
+      LSDFCompare( grid, w, h, p, x, y, -1, 0 );
+      LSDFCompare( grid, w, h, p, x, y, 0, -1 );
+      LSDFCompare( grid, w, h, p, x, y, -1, -1 );
+      LSDFCompare( grid, w, h, p, x, y, 1, -1 );
+    }
+    for ( int x = w - 1; x >= 0; --x ) {
+      LSDFCompare( grid, w, h, &grid[y * w + x], x, y, 1, 0 );
+    }
+  }
+  for ( int y = h - 1; y >= 0; --y ) {
+    for ( int x = w - 1; x >= 0; --x ) {
+      LSDFOffset* p = &grid[y * w + x];
+      LSDFCompare( grid, w, h, p, x, y, 1, 0 );
+      LSDFCompare( grid, w, h, p, x, y, 0, 1 );
+      LSDFCompare( grid, w, h, p, x, y, -1, 1 );
+      LSDFCompare( grid, w, h, p, x, y, 1, 1 );
+    }
+    for ( int x = 0; x < w; ++x ) {
+      LSDFCompare( grid, w, h, &grid[y * w + x], x, y, -1, 0 );
+    }
+  }
+}
+
+// Writes distance field of glyph surface into atlas cell
+static bool LSDFFontEncodeGlyph( LSDFFont* lSDFFont, SDL_Surface* glyph,
+                                 SDL_Rect* cell ) {
+  int w = cell->w;
+  int h = cell->h;
+  int spread = lSDFFont->mSpread;
+  LSDFOffset far = { 9999, 9999 };
+  LSDFOffset zero = { 0, 0 };
+
+  // Distances to nearest inside and to nearest outside pixel
+  LSDFOffset* toInside =
+      (LSDFOffset*)malloc( sizeof( LSDFOffset ) * (size_t)( w * h ) );
+  LSDFOffset* toOutside =
+      (LSDFOffset*)malloc( sizeof( LSDFOffset ) * (size_t)( w * h ) );
+  if ( toInside == NULL || toOutside == NULL ) {
+    free( toInside );
+    free( toOutside );
+    return false;
+  }
+
+  // Seed grids from glyph coverage, padding counts as outside
+  SDL_LockSurface( glyph );
+  for ( int y = 0; y < h; ++y ) {
+    for ( int x = 0; x < w; ++x ) {
+      int gx = x - spread;
+      int gy = y - spread;
+      bool inside = false;
+      if ( gx >= 0 && gy >= 0 && gx < glyph->w && gy < glyph->h ) {
+        Uint32 pixel =
+            ( (Uint32*)( (Uint8*)glyph->pixels + gy * glyph->pitch ) )[gx];
+        Uint8 r, g, b, a;
+        SDL_GetRGBA( pixel, glyph->format, &r, &g, &b, &a );
+        inside = a >= 0x80;
+      }
+      toInside[y * w + x] = inside ? zero : far;
+      toOutside[y * w + x] = inside ? far : zero;
+    }
+  }
+  SDL_UnlockSurface( glyph );
+
+  LSDFTransform( toInside, w, h );
+  LSDFTransform( toOutside, w, h );
+
+  // Positive inside, 128 on the outline, spread pixels map to full range
+  for ( int y = 0; y < h; ++y ) {
+    for ( int x = 0; x < w; ++x ) {
+      LSDFOffset in = toInside[y * w + x];
+      LSDFOffset out = toOutside[y * w + x];
+      double distance = sqrt( (double)( out.dx * out.dx + out.dy * out.dy ) ) -
+                        sqrt( (double)( in.dx * in.dx + in.dy * in.dy ) );
+      double value = 128.0 + distance * 127.0 / spread;
+      lSDFFont->mAtlas[( cell->y + y ) * lSDFFont->mAtlasWidth + cell->x + x] =
+          (Uint8)fmin( fmax( value, 0.0 ), 255.0 );
+    }
+  }
+
+  free( toInside );
+  free( toOutside );
+  return true;
+}
+
+bool LSDFFontBuild( LSDFFont* lSDFFont, TTF_Font* gFont, int spread ) {
+  // Get rid of preexisting atlas
+  LSDFFontFree( lSDFFont );
+  lSDFFont->mSpread = spread;
+  lSDFFont->mBaseHeight = TTF_FontHeight( gFont );
+
+  // Rasterize each glyph once at base size
+  SDL_Surface* glyphs[LSDF_GLYPH_COUNT];
+  SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+  bool success = true;
+  for ( int i = 0; i < LSDF_GLYPH_COUNT; ++i ) {
+    Uint16 ch = (Uint16)( LSDF_FIRST_GLYPH + i );
+    int minx, maxx, miny, maxy, advance;
+    glyphs[i] = NULL;
+    if ( TTF_GlyphMetrics( gFont, ch, &minx, &maxx, &miny, &maxy, &advance ) !=
+         0 ) {
+      advance = 0;
+    }
+    lSDFFont->mGlyphs[i].mAdvance = advance;
+    if ( ch != ' ' ) {
+      glyphs[i] = TTF_RenderGlyph_Blended( gFont, ch, white );
+      LMemoryTrackSurface( glyphs[i], "LSDFFont glyph" );
+    }
+  }
+
+  // Pack padded cells into shelves
+  int x = 0;
+  int y = 0;
+  int shelfHeight = 0;
+  for ( int i = 0; i < LSDF_GLYPH_COUNT; ++i ) {
+    SDL_Rect* cell = &lSDFFont->mGlyphs[i].mRect;
+    cell->w = glyphs[i] != NULL ? glyphs[i]->w + 2 * spread : 0;
+    cell->h = glyphs[i] != NULL ? glyphs[i]->h + 2 * spread : 0;
+    if ( x + cell->w > LSDF_ATLAS_WIDTH ) {
+      x = 0;
+      y += shelfHeight;
+      shelfHeight = 0;
+    }
+    cell->x = x;
+    cell->y = y;
+    x += cell->w;
+    shelfHeight = cell->h > shelfHeight ? cell->h : shelfHeight;
+  }
+  lSDFFont->mAtlasWidth = LSDF_ATLAS_WIDTH;
+  lSDFFont->mAtlasHeight = y + shelfHeight;
+
+  // Encode distances
+  lSDFFont->mAtlas = (Uint8*)calloc(
+      (size_t)lSDFFont->mAtlasWidth * (size_t)lSDFFont->mAtlasHeight, 1 );
+  if ( lSDFFont->mAtlas == NULL ) {
+    printf( "Unable to allocate distance field atlas!\n" );
+    success = false;
+  }
+  for ( int i = 0; i < LSDF_GLYPH_COUNT; ++i ) {
+    if ( glyphs[i] == NULL ) {
+      continue;
+    }
+    if ( success &&
+         !LSDFFontEncodeGlyph( lSDFFont, glyphs[i],
+                               &lSDFFont->mGlyphs[i].mRect ) ) {
+      printf( "Unable to encode distance field glyph!\n" );
+      success = false;
+    }
+    LMemoryUntrack( glyphs[i] );
+    SDL_FreeSurface( glyphs[i] );
+  }
+
+  if ( !success ) {
+    LSDFFontFree( lSDFFont );
+  }
+  return success;
+}
+
+// Bilinearly samples glyph distance in base pixels, positive inside
+static double LSDFFontSample( LSDFFont* lSDFFont, LSDFGlyph* glyph, double x,
+                              double y ) {
+  if ( x < 0 || y < 0 || x > glyph->mRect.w - 1 || y > glyph->mRect.h - 1 ) {
+    return -lSDFFont->mSpread;
+  }
+  int x0 = (int)x;
+  int y0 = (int)y;
+  int x1 = x0 + 1 < glyph->mRect.w ? x0 + 1 : x0;
+  int y1 = y0 + 1 < glyph->mRect.h ? y0 + 1 : y0;
+  double fx = x - x0;
+  double fy = y - y0;
+  const Uint8* row0 = lSDFFont->mAtlas +
+                      ( glyph->mRect.y + y0 ) * lSDFFont->mAtlasWidth +
+                      glyph->mRect.x;
+  const Uint8* row1 = lSDFFont->mAtlas +
+                      ( glyph->mRect.y + y1 ) * lSDFFont->mAtlasWidth +
+                      glyph->mRect.x;
+  double top = row0[x0] + ( row0[x1] - row0[x0] ) * fx;
+  double bottom = row1[x0] + ( row1[x1] - row1[x0] ) * fx;
+  double value = top + ( bottom - top ) * fy;
+  return ( value - 128.0 ) * lSDFFont->mSpread / 127.0;
+}
+
+// Converts signed distance in output pixels to antialiased coverage
+static Uint8 LSDFCoverage( double distance ) {
+  return (Uint8)( fmin( fmax( distance + 0.5, 0.0 ), 1.0 ) * 255.0 + 0.5 );
+}
+
+// Composites straight alpha color over pixel
+static Uint32 LSDFBlend( Uint32 dst, SDL_Color color, Uint8 coverage ) {
+  double srcA = coverage / 255.0 * color.a / 255.0;
+  double dstA = ( dst >> 24 ) / 255.0;
+  double outA = srcA + dstA * ( 1.0 - srcA );
+  if ( outA <= 0.0 ) {
+    return 0;
+  }
+  double channels[3];
+  Uint8 src[3] = { color.r, color.g, color.b };
+  for ( int c = 0; c < 3; ++c ) {
+    double d = ( dst >> ( 16 - 8 * c ) ) & 0xFF;
+    channels[c] = ( src[c] * srcA + d * dstA * ( 1.0 - srcA ) ) / outA;
+  }
+  return (Uint32)( outA * 255.0 + 0.5 ) << 24 |
+         (Uint32)( channels[0] + 0.5 ) << 16 |
+         (Uint32)( channels[1] + 0.5 ) << 8 | (Uint32)( channels[2] + 0.5 );
+}
+
+bool LSDFFontRenderText( LSDFFont* lSDFFont, LTexture* lTexture,
+                         SDL_Renderer* gRenderer, const char* text,
+                         int pixelHeight, SDL_Color textColor,
+                         const LSDFStyle* style ) {
+  if ( lSDFFont->mAtlas == NULL ) {
+    return false;
+  }
+
+  LSDFStyle plain;
+  memset( &plain, 0, sizeof( plain ) );
+  if ( style == NULL ) {
+    style = &plain;
+  }
+  bool shadow = style->mShadowColor.a > 0;
+  double scale = (double)pixelHeight / lSDFFont->mBaseHeight;
+
+  // Outline can't reach further than the stored distances
+  double outline =
+      fmax( fmin( style->mOutline, lSDFFont->mSpread * scale - 1.0 ), 0.0 );
+
+  // Measure text, skipping UTF-8 continuation bytes
+  int penWidth = 0;
+  for ( const char* c = text; *c != '\0'; ++c ) {
+    Uint8 ch = (Uint8)*c;
+    if ( ( ch & 0xC0 ) == 0x80 ) {
+      continue;
+    }
+    if ( ch < LSDF_FIRST_GLYPH || ch >= LSDF_FIRST_GLYPH + LSDF_GLYPH_COUNT ) {
+      ch = '?';
+    }
+    penWidth += lSDFFont->mGlyphs[ch - LSDF_FIRST_GLYPH].mAdvance;
+  }
+  int margin = (int)ceil( outline ) +
+               ( shadow ? SDL_max( abs( style->mShadowX ),
+                                   abs( style->mShadowY ) )
+                        : 0 ) +
+               1;
+  int width = (int)ceil( penWidth * scale ) + 2 * margin;
+  int height = pixelHeight + 2 * margin;
+
+  // Coverage planes for each layer
+  size_t pixelCount = (size_t)width * (size_t)height;
+  Uint8* planes = (Uint8*)calloc( pixelCount * 3, 1 );
+  Uint32* pixels = (Uint32*)calloc( pixelCount, sizeof( Uint32 ) );
+  if ( planes == NULL || pixels == NULL ) {
+    printf( "Unable to allocate distance field text!\n" );
+    free( planes );
+    free( pixels );
+    return false;
+  }
+  Uint8* fill = planes;
+  Uint8* outlinePlane = planes + pixelCount;
+  Uint8* shadowPlane = planes + 2 * pixelCount;
+
+  // Evaluate each glyph's cell, overlapping padding keeps the maximum
+  double penX = 0;
+  for ( const char* c = text; *c != '\0'; ++c ) {
+    Uint8 ch = (Uint8)*c;
+    if ( ( ch & 0xC0 ) == 0x80 ) {
+      continue;
+    }
+    if ( ch < LSDF_FIRST_GLYPH || ch >= LSDF_FIRST_GLYPH + LSDF_GLYPH_COUNT ) {
+      ch = '?';
+    }
+    LSDFGlyph* glyph = &lSDFFont->mGlyphs[ch - LSDF_FIRST_GLYPH];
+    double originX = margin + ( penX - lSDFFont->mSpread ) * scale;
+    double originY = margin - lSDFFont->mSpread * scale;
+    penX += glyph->mAdvance;
+    if ( glyph->mRect.w == 0 ) {
+      continue;
+    }
+
+    int left = SDL_max( (int)floor( originX ) - margin, 0 );
+    int top = SDL_max( (int)floor( originY ) - margin, 0 );
+    int right = SDL_min(
+        (int)ceil( originX + glyph->mRect.w * scale ) + margin, width );
+    int bottom = SDL_min(
+        (int)ceil( originY + glyph->mRect.h * scale ) + margin, height );
+    for ( int y = top; y < bottom; ++y ) {
+      for ( int x = left; x < right; ++x ) {
+        size_t i = (size_t)y * (size_t)width + (size_t)x;
+        double d = LSDFFontSample( lSDFFont, glyph,
+                                   ( x + 0.5 - originX ) / scale - 0.5,
+                                   ( y + 0.5 - originY ) / scale - 0.5 ) *
+                   scale;
+        fill[i] = SDL_max( fill[i], LSDFCoverage( d ) );
+        if ( outline > 0 ) {
+          outlinePlane[i] =
+              SDL_max( outlinePlane[i], LSDFCoverage( d + outline ) );
+        }
+        if ( shadow ) {
+          double s = LSDFFontSample(
+                         lSDFFont, glyph,
+                         ( x - style->mShadowX + 0.5 - originX ) / scale - 0.5,
+                         ( y - style->mShadowY + 0.5 - originY ) / scale -
+                             0.5 ) *
+                     scale;
+          shadowPlane[i] =
+              SDL_max( shadowPlane[i], LSDFCoverage( s + outline ) );
+        }
+      }
+    }
+  }
+
+  // Composite shadow, outline and fill
+  for ( size_t i = 0; i < pixelCount; ++i ) {
+    Uint32 pixel = 0;
+    if ( shadowPlane[i] > 0 ) {
+      pixel = LSDFBlend( pixel, style->mShadowColor, shadowPlane[i] );
+    }
+    if ( outlinePlane[i] > 0 ) {
+      pixel = LSDFBlend( pixel, style->mOutlineColor, outlinePlane[i] );
+    }
+    if ( fill[i] > 0 ) {
+      pixel = LSDFBlend( pixel, textColor, fill[i] );
+    }
+    pixels[i] = pixel;
+  }
+  free( planes );
+
+  // Reuse streaming texture when size matches
+  int access = -1;
+  int textureWidth = 0;
+  int textureHeight = 0;
+  if ( lTexture->mTexture != NULL ) {
+    SDL_QueryTexture( lTexture->mTexture, NULL, &access, &textureWidth,
+                      &textureHeight );
+  }
+  if ( access != SDL_TEXTUREACCESS_STREAMING || textureWidth != width ||
+       textureHeight != height ) {
+    LTextureFree( lTexture );
+    lTexture->mTexture =
+        SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_ARGB8888,
+                           SDL_TEXTUREACCESS_STREAMING, width, height );
+    if ( lTexture->mTexture == NULL ) {
+      printf( "Unable to create distance field text texture! SDL Error: %s\n",
+              SDL_GetError() );
+      free( pixels );
+      return false;
+    }
+    SDL_SetTextureBlendMode( lTexture->mTexture, SDL_BLENDMODE_BLEND );
+    LMemoryTrackTexture( lTexture->mTexture, "LSDFFont" );
+    lTexture->mWidth = width;
+    lTexture->mHeight = height;
+  }
+
+  // Upload evaluated pixels
+  if ( SDL_UpdateTexture( lTexture->mTexture, NULL, pixels,
+                          width * (int)sizeof( Uint32 ) ) != 0 ) {
+    printf( "Unable to upload distance field text! SDL Error: %s\n",
+            SDL_GetError() );
+  }
+  free( pixels );
+
+  return true;
+}
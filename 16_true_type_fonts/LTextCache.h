@@ -0,0 +1,271 @@
+#include "LTexture.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Number of hash buckets, must be a power of two
+#define LTEXT_CACHE_BUCKETS 256
+
+// How glyphs are rasterized, matching the TTF_RenderUTF8_* functions
+typedef enum LTextRenderMode {
+  LTEXT_RENDER_SOLID,
+  LTEXT_RENDER_BLENDED
+} LTextRenderMode;
+
+// Cached rendered string
+typedef struct LTextCacheEntry LTextCacheEntry;
+
+// LRU cache of rendered text textures with a byte budget
+typedef struct LTextCache LTextCache;
+
+// creates LTextCache holding at most budget bytes of textures
+LTextCache LTextCacheNew( size_t budget );
+
+// Deallocates LTextCache and all of its textures
+void LTextCacheFree( LTextCache* lTextCache );
+
+// Returns texture for text, rendering it only if it is not cached yet
+// The texture stays owned by the cache and is valid until a later call evicts
+// it, so look it up again instead of keeping the pointer across frames
+LTexture* LTextCacheGet( LTextCache* lTextCache, SDL_Renderer* gRenderer,
+                         TTF_Font* gFont, int ptsize, const char* text,
+                         SDL_Color textColor, LTextRenderMode mode );
+
+// Prints hit rate and memory use
+void LTextCachePrintStats( LTextCache* lTextCache );
+
+typedef struct LTextCacheEntry {
+  // Key
+  TTF_Font* mFont;
+  int mPtsize;
+  char* mText;
+  SDL_Color mColor;
+  LTextRenderMode mMode;
+  Uint32 mHash;
+
+  // Rendered text and its size in bytes
+  LTexture mTexture;
+  size_t mBytes;
+
+  // Links in recently used list, most recent first
+  LTextCacheEntry* mPrev;
+  LTextCacheEntry* mNext;
+
+  // Next entry in same hash bucket
+  LTextCacheEntry* mChain;
+} LTextCacheEntry;
+
+typedef struct LTextCache {
+  LTextCacheEntry* mBuckets[LTEXT_CACHE_BUCKETS];
+
+  // Most and least recently used entries
+  LTextCacheEntry* mHead;
+  LTextCacheEntry* mTail;
+
+  // Texture memory held and allowed
+  size_t mBytes;
+  size_t mBudget;
+
+  // Statistics
+  Uint64 mHits;
+  Uint64 mMisses;
+  Uint64 mEvictions;
+} LTextCache;
+
+LTextCache LTextCacheNew( size_t budget ) {
+  LTextCache lTextCache;
+  memset( &lTextCache, 0, sizeof( lTextCache ) );
+  lTextCache.mBudget = budget;
+  return lTextCache;
+}
+
+// FNV-1a over all key fields
+static Uint32 LTextCacheHash( TTF_Font* gFont, int ptsize, const char* text,
+                              SDL_Color textColor, LTextRenderMode mode ) {
+  Uint32 hash = 2166136261u;
+  uintptr_t font = (uintptr_t)gFont;
+  Uint32 fields[4];
+  fields[0] = (Uint32)font ^ (Uint32)( (Uint64)font >> 32 );
+  fields[1] = (Uint32)ptsize;
+  fields[2] = (Uint32)textColor.r | (Uint32)textColor.g << 8 |
+              (Uint32)textColor.b << 16 | (Uint32)textColor.a << 24;
+  fields[3] = (Uint32)mode;
+  for ( size_t i = 0; i < sizeof( fields ); ++i ) {
+    hash = ( hash ^ ( (const Uint8*)fields )[i] ) * 16777619u;
+  }
+  for ( const char* c = text; *c != '\0'; ++c ) {
+    hash = ( hash ^ (Uint8)*c ) * 16777619u;
+  }
+  return hash;
+}
+
+// Unlinks entry from recently used list
+static void LTextCacheUnlink( LTextCache* lTextCache, LTextCacheEntry* entry ) {
+  if ( entry->mPrev != NULL ) {
+    entry->mPrev->mNext = entry->mNext;
+  } else {
+    lTextCache->mHead = entry->mNext;
+  }
+  if ( entry->mNext != NULL ) {
+    entry->mNext->mPrev = entry->mPrev;
+  } else {
+    lTextCache->mTail = entry->mPrev;
+  }
+  entry->mPrev = NULL;
+  entry->mNext = NULL;
+}
+
+// Links entry as most recently used
+static void LTextCachePushFront( LTextCache* lTextCache,
+                                 LTextCacheEntry* entry ) {
+  entry->mPrev = NULL;
+  entry->mNext = lTextCache->mHead;
+  if ( lTextCache->mHead != NULL ) {
+    lTextCache->mHead->mPrev = entry;
+  } else {
+    lTextCache->mTail = entry;
+  }
+  lTextCache->mHead = entry;
+}
+
+// Removes entry from cache and frees it
+static void LTextCacheRemove( LTextCache* lTextCache, LTextCacheEntry* entry ) {
+  LTextCacheEntry** link =
+      &lTextCache->mBuckets[entry->mHash & ( LTEXT_CACHE_BUCKETS - 1 )];
+  while ( *link != entry ) {
+    link = &( *link )->mChain;
+  }
+  *link = entry->mChain;
+
+  LTextCacheUnlink( lTextCache, entry );
+  lTextCache->mBytes -= entry->mBytes;
+  LTextureFree( &entry->mTexture );
+  free( entry->mText );
+  free( entry );
+}
+
+void LTextCacheFree( LTextCache* lTextCache ) {
+  while ( lTextCache->mHead != NULL ) {
+    LTextCacheRemove( lTextCache, lTextCache->mHead );
+  }
+}
+
+// Renders text into entry's texture
+static bool LTextCacheRender( LTextCacheEntry* entry,
+                              SDL_Renderer* gRenderer ) {
+  // Render text surface
+  SDL_Surface* textSurface = NULL;
+  switch ( entry->mMode ) {
+  case LTEXT_RENDER_SOLID:
+    textSurface = TTF_RenderUTF8_Solid( entry->mFont, entry->mText,
+                                        entry->mColor );
+    break;
+
+  case LTEXT_RENDER_BLENDED:
+    textSurface = TTF_RenderUTF8_Blended( entry->mFont, entry->mText,
+                                          entry->mColor );
+    break;
+  }
+  if ( textSurface == NULL ) {
+    printf( "Unable to render text surface! SDL_ttf Error: %s\n",
+            TTF_GetError() );
+    return false;
+  }
+  LMemoryTrackSurface( textSurface, "LTextCache" );
+
+  // Create texture in the renderer's own format
+  if ( !LTextureUpload( &entry->mTexture, gRenderer, textSurface,
+                        "LTextCache" ) ) {
+    printf( "Unable to create texture from rendered text!\n" );
+  } else {
+    // Get memory use
+    Uint32 format;
+    SDL_QueryTexture( entry->mTexture.mTexture, &format, NULL, NULL, NULL );
+    entry->mBytes = (size_t)textSurface->w * (size_t)textSurface->h *
+                    (size_t)SDL_BYTESPERPIXEL( format );
+  }
+
+  // Get rid of old surface
+  LMemoryUntrack( textSurface );
+  SDL_FreeSurface( textSurface );
+
+  return entry->mTexture.mTexture != NULL;
+}
+
+LTexture* LTextCacheGet( LTextCache* lTextCache, SDL_Renderer* gRenderer,
+                         TTF_Font* gFont, int ptsize, const char* text,
+                         SDL_Color textColor, LTextRenderMode mode ) {
+  Uint32 hash = LTextCacheHash( gFont, ptsize, text, textColor, mode );
+  LTextCacheEntry** bucket =
+      &lTextCache->mBuckets[hash & ( LTEXT_CACHE_BUCKETS - 1 )];
+
+  // Look for previously rendered text
+  for ( LTextCacheEntry* entry = *bucket; entry != NULL;
+        entry = entry->mChain ) {
+    if ( entry->mHash == hash && entry->mFont == gFont &&
+         entry->mPtsize == ptsize && entry->mMode == mode &&
+         entry->mColor.r == textColor.r && entry->mColor.g == textColor.g &&
+         entry->mColor.b == textColor.b && entry->mColor.a == textColor.a &&
+         strcmp( entry->mText, text ) == 0 ) {
+      ++lTextCache->mHits;
+      LTextCacheUnlink( lTextCache, entry );
+      LTextCachePushFront( lTextCache, entry );
+      return &entry->mTexture;
+    }
+  }
+  ++lTextCache->mMisses;
+
+  // Render new entry
+  LTextCacheEntry* entry =
+      (LTextCacheEntry*)calloc( 1, sizeof( LTextCacheEntry ) );
+  if ( entry == NULL ) {
+    printf( "Unable to allocate text cache entry!\n" );
+    return NULL;
+  }
+  entry->mFont = gFont;
+  entry->mPtsize = ptsize;
+  entry->mText = (char*)malloc( strlen( text ) + 1 );
+  entry->mColor = textColor;
+  entry->mMode = mode;
+  entry->mHash = hash;
+  if ( entry->mText == NULL ) {
+    printf( "Unable to allocate text cache entry!\n" );
+    free( entry );
+    return NULL;
+  }
+  strcpy( entry->mText, text );
+  LTraceBeginDetail( "LTextCacheRender", text );
+  bool rendered = LTextCacheRender( entry, gRenderer );
+  LTraceEnd();
+  if ( !rendered ) {
+    free( entry->mText );
+    free( entry );
+    return NULL;
+  }
+
+  // Insert as most recently used
+  entry->mChain = *bucket;
+  *bucket = entry;
+  LTextCachePushFront( lTextCache, entry );
+  lTextCache->mBytes += entry->mBytes;
+
+  // Evict least recently used entries over budget, keeping the new one
+  while ( lTextCache->mBytes > lTextCache->mBudget &&
+          lTextCache->mTail != entry ) {
+    LTextCacheRemove( lTextCache, lTextCache->mTail );
+    ++lTextCache->mEvictions;
+  }
+
+  return &entry->mTexture;
+}
+
+void LTextCachePrintStats( LTextCache* lTextCache ) {
+  Uint64 lookups = lTextCache->mHits + lTextCache->mMisses;
+  printf( "Text cache: %llu hits, %llu misses (%.1f%% hit rate), %llu "
+          "evictions, %zu / %zu bytes\n",
+          (unsigned long long)lTextCache->mHits,
+          (unsigned long long)lTextCache->mMisses,
+          lookups > 0 ? 100.0 * (double)lTextCache->mHits / (double)lookups
+                      : 0.0,
+          (unsigned long long)lTextCache->mEvictions, lTextCache->mBytes,
+          lTextCache->mBudget );
+}
@@ -0,0 +1,388 @@
+#include "LTexture.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Longest run in bytes, longer spans of one class are split between code
+// points
+#define LTEXTLABEL_RUN_BYTES 256
+
+// Laid out span of same class characters (letters, digits, spaces, symbols)
+typedef struct LTextRun LTextRun;
+
+// Text that rerasterizes only the runs that changed since the last update
+// Runs are kept in a persistent streaming texture, so updating a counter or a
+// clock costs time proportional to the edit rather than the whole string
+typedef struct LTextLabel LTextLabel;
+
+// creates LTextLabel with default values
+LTextLabel LTextLabelNew( void );
+
+// Deallocates LTextLabel
+void LTextLabelFree( LTextLabel* lTextLabel );
+
+// Updates label text, uploading only changed runs
+bool LTextLabelSetText( LTextLabel* lTextLabel, SDL_Renderer* gRenderer,
+                        TTF_Font* gFont, const char* text,
+                        SDL_Color textColor );
+
+// Renders label at given point
+void LTextLabelRender( LTextLabel* lTextLabel, SDL_Renderer* gRenderer, int x,
+                       int y );
+
+typedef struct LTextRun {
+  // Bytes of label text in this run
+  int mStart;
+  int mLength;
+
+  // Horizontal placement in texture
+  int mX;
+  int mWidth;
+} LTextRun;
+
+typedef struct LTextLabel {
+  // Streaming texture, may be wider than the current text
+  LTexture mTexture;
+
+  // Current text and its layout
+  char* mText;
+  LTextRun* mRuns;
+  int mRunCount;
+  int mWidth;
+  int mHeight;
+
+  // Next text and layout being built, swapped with the current ones
+  char* mNextText;
+  LTextRun* mNextRuns;
+
+  // Which new runs match an old one and which old runs are still in place
+  bool* mReused;
+  bool* mKept;
+
+  // Bytes of each text buffer and entries of each run buffer, buffers only
+  // grow so steady updates don't allocate
+  size_t mTextCapacity;
+  size_t mRunCapacity;
+
+  // Font and color runs were rasterized with
+  TTF_Font* mFont;
+  SDL_Color mColor;
+
+  // Pixels uploaded and runs measured over the label's lifetime
+  Uint64 mUploadedPixels;
+  Uint64 mMeasuredRuns;
+} LTextLabel;
+
+LTextLabel LTextLabelNew() {
+  LTextLabel lTextLabel;
+  memset( &lTextLabel, 0, sizeof( lTextLabel ) );
+  return lTextLabel;
+}
+
+void LTextLabelFree( LTextLabel* lTextLabel ) {
+  LTextureFree( &lTextLabel->mTexture );
+  free( lTextLabel->mText );
+  free( lTextLabel->mRuns );
+  free( lTextLabel->mNextText );
+  free( lTextLabel->mNextRuns );
+  free( lTextLabel->mReused );
+  free( lTextLabel->mKept );
+  *lTextLabel = LTextLabelNew();
+}
+
+// Grows buffers to hold text of given length, keeping their contents
+static bool LTextLabelReserve( LTextLabel* lTextLabel, size_t length ) {
+  if ( length + 1 > lTextLabel->mTextCapacity ) {
+    size_t capacity = SDL_max( length + 1, 2 * lTextLabel->mTextCapacity );
+    char* text = (char*)realloc( lTextLabel->mText, capacity );
+    if ( text == NULL ) {
+      return false;
+    }
+    lTextLabel->mText = text;
+    char* nextText = (char*)realloc( lTextLabel->mNextText, capacity );
+    if ( nextText == NULL ) {
+      return false;
+    }
+    lTextLabel->mNextText = nextText;
+    lTextLabel->mTextCapacity = capacity;
+  }
+
+  // A run is at least one byte
+  if ( length + 1 > lTextLabel->mRunCapacity ) {
+    size_t capacity = SDL_max( length + 1, 2 * lTextLabel->mRunCapacity );
+    LTextRun* runs = (LTextRun*)realloc( lTextLabel->mRuns,
+                                         sizeof( LTextRun ) * capacity );
+    if ( runs == NULL ) {
+      return false;
+    }
+    lTextLabel->mRuns = runs;
+    LTextRun* nextRuns = (LTextRun*)realloc( lTextLabel->mNextRuns,
+                                             sizeof( LTextRun ) * capacity );
+    if ( nextRuns == NULL ) {
+      return false;
+    }
+    lTextLabel->mNextRuns = nextRuns;
+    bool* reused =
+        (bool*)realloc( lTextLabel->mReused, sizeof( bool ) * capacity );
+    if ( reused == NULL ) {
+      return false;
+    }
+    lTextLabel->mReused = reused;
+    bool* kept = (bool*)realloc( lTextLabel->mKept, sizeof( bool ) * capacity );
+    if ( kept == NULL ) {
+      return false;
+    }
+    lTextLabel->mKept = kept;
+    lTextLabel->mRunCapacity = capacity;
+  }
+  return true;
+}
+
+// Groups characters so edits to numbers don't touch surrounding words
+static int LTextLabelCharClass( char c ) {
+  Uint8 ch = (Uint8)c;
+  if ( ch == ' ' ) {
+    return 0;
+  } else if ( ch >= '0' && ch <= '9' ) {
+    return 1;
+  } else if ( ( ch >= 'a' && ch <= 'z' ) || ( ch >= 'A' && ch <= 'Z' ) ||
+              ch >= 0x80 ) {
+    return 2;
+  }
+  return 3;
+}
+
+// Returns whether byte continues a UTF-8 sequence
+static bool LTextLabelIsContinuation( char c ) {
+  return ( (Uint8)c & 0xC0 ) == 0x80;
+}
+
+// Splits next text into runs, measuring only runs that don't match an old
+// run with the same bytes at the same place. Marks matches in mReused and
+// mKept and returns the next text's width
+static int LTextLabelLayout( LTextLabel* lTextLabel, TTF_Font* gFont,
+                             int* runCount ) {
+  const char* text = lTextLabel->mNextText;
+  LTextRun* runs = lTextLabel->mNextRuns;
+  int count = 0;
+  int x = 0;
+  int oldIndex = 0;
+  char buffer[LTEXTLABEL_RUN_BYTES];
+  for ( int start = 0; text[start] != '\0'; ) {
+    // Extend run while class stays the same, keeping UTF-8 sequences whole
+    int end = start + 1;
+    while ( text[end] != '\0' &&
+            ( LTextLabelIsContinuation( text[end] ) ||
+              LTextLabelCharClass( text[end] ) ==
+                  LTextLabelCharClass( text[start] ) ) &&
+            end - start < LTEXTLABEL_RUN_BYTES - 1 ) {
+      ++end;
+    }
+
+    // A full run ends before the code point it would otherwise split
+    while ( end - start > 1 && LTextLabelIsContinuation( text[end] ) ) {
+      --end;
+    }
+
+    LTextRun* run = &runs[count];
+    run->mStart = start;
+    run->mLength = end - start;
+    run->mX = x;
+    lTextLabel->mReused[count] = false;
+
+    // Old runs are sorted by x, so walk them alongside
+    while ( oldIndex < lTextLabel->mRunCount &&
+            lTextLabel->mRuns[oldIndex].mX < x ) {
+      ++oldIndex;
+    }
+    if ( oldIndex < lTextLabel->mRunCount ) {
+      LTextRun* old = &lTextLabel->mRuns[oldIndex];
+      if ( old->mX == x && old->mLength == run->mLength &&
+           memcmp( lTextLabel->mText + old->mStart, text + start,
+                   (size_t)old->mLength ) == 0 ) {
+        run->mWidth = old->mWidth;
+        lTextLabel->mReused[count] = true;
+        lTextLabel->mKept[oldIndex] = true;
+      }
+    }
+
+    if ( !lTextLabel->mReused[count] ) {
+      memcpy( buffer, text + start, (size_t)run->mLength );
+      buffer[run->mLength] = '\0';
+      if ( TTF_SizeUTF8( gFont, buffer, &run->mWidth, NULL ) != 0 ) {
+        run->mWidth = 0;
+      }
+      ++lTextLabel->mMeasuredRuns;
+    }
+    x += run->mWidth;
+    ++count;
+    start = end;
+  }
+  *runCount = count;
+  return x;
+}
+
+// Clears part of the texture to transparent
+static void LTextLabelClear( LTextLabel* lTextLabel, int x, int width ) {
+  SDL_Rect rect = { x, 0, width, lTextLabel->mHeight };
+  if ( rect.x + rect.w > lTextLabel->mTexture.mWidth ) {
+    rect.w = lTextLabel->mTexture.mWidth - rect.x;
+  }
+  if ( rect.w <= 0 ) {
+    return;
+  }
+
+  void* pixels;
+  int pitch;
+  if ( SDL_LockTexture( lTextLabel->mTexture.mTexture, &rect, &pixels,
+                        &pitch ) != 0 ) {
+    printf( "Unable to lock label texture! SDL Error: %s\n", SDL_GetError() );
+    return;
+  }
+  for ( int row = 0; row < rect.h; ++row ) {
+    memset( (Uint8*)pixels + row * pitch, 0,
+            (size_t)rect.w * sizeof( Uint32 ) );
+  }
+  SDL_UnlockTexture( lTextLabel->mTexture.mTexture );
+  lTextLabel->mUploadedPixels += (Uint64)rect.w * (Uint64)rect.h;
+}
+
+// Rasterizes one run into its place in the texture
+static void LTextLabelUploadRun( LTextLabel* lTextLabel, const char* text,
+                                 LTextRun* run ) {
+  char buffer[LTEXTLABEL_RUN_BYTES];
+  memcpy( buffer, text + run->mStart, (size_t)run->mLength );
+  buffer[run->mLength] = '\0';
+
+  SDL_Surface* runSurface =
+      TTF_RenderUTF8_Blended( lTextLabel->mFont, buffer, lTextLabel->mColor );
+  if ( runSurface == NULL ) {
+    printf( "Unable to render text surface! SDL_ttf Error: %s\n",
+            TTF_GetError() );
+    return;
+  }
+  LMemoryTrackSurface( runSurface, "LTextLabel run" );
+
+  SDL_Rect rect = { run->mX, 0, run->mWidth,
+                    SDL_min( runSurface->h, lTextLabel->mHeight ) };
+  rect.w = SDL_min( rect.w, runSurface->w );
+  rect.w = SDL_min( rect.w, lTextLabel->mTexture.mWidth - rect.x );
+  if ( rect.w > 0 && rect.h > 0 ) {
+    SDL_UpdateTexture( lTextLabel->mTexture.mTexture, &rect,
+                       runSurface->pixels, runSurface->pitch );
+    lTextLabel->mUploadedPixels += (Uint64)rect.w * (Uint64)rect.h;
+  }
+  LMemoryUntrack( runSurface );
+  SDL_FreeSurface( runSurface );
+}
+
+bool LTextLabelSetText( LTextLabel* lTextLabel, SDL_Renderer* gRenderer,
+                        TTF_Font* gFont, const char* text,
+                        SDL_Color textColor ) {
+  // Nothing to do for unchanged text
+  if ( lTextLabel->mTexture.mTexture != NULL && lTextLabel->mFont == gFont &&
+       lTextLabel->mColor.r == textColor.r &&
+       lTextLabel->mColor.g == textColor.g &&
+       lTextLabel->mColor.b == textColor.b &&
+       lTextLabel->mColor.a == textColor.a &&
+       strcmp( lTextLabel->mText, text ) == 0 ) {
+    return true;
+  }
+
+  size_t length = strlen( text );
+  if ( !LTextLabelReserve( lTextLabel, length ) ) {
+    printf( "Unable to allocate text label!\n" );
+    return false;
+  }
+  memcpy( lTextLabel->mNextText, text, length + 1 );
+
+  // Font, color or height changes invalidate every run
+  int height = TTF_FontHeight( gFont );
+  bool restyle =
+      lTextLabel->mTexture.mTexture == NULL || lTextLabel->mFont != gFont ||
+      lTextLabel->mColor.r != textColor.r ||
+      lTextLabel->mColor.g != textColor.g ||
+      lTextLabel->mColor.b != textColor.b ||
+      lTextLabel->mColor.a != textColor.a || lTextLabel->mHeight != height;
+  if ( restyle ) {
+    lTextLabel->mRunCount = 0;
+  }
+
+  // Lay out new text, measuring only runs that changed
+  for ( int i = 0; i < lTextLabel->mRunCount; ++i ) {
+    lTextLabel->mKept[i] = false;
+  }
+  int runCount;
+  int width = LTextLabelLayout( lTextLabel, gFont, &runCount );
+
+  if ( restyle || width > lTextLabel->mTexture.mWidth ) {
+    // Grow geometrically so a lengthening counter doesn't reallocate each time
+    int capacity = lTextLabel->mTexture.mWidth;
+    if ( width > capacity ) {
+      capacity = SDL_max( width, 2 * capacity );
+    }
+    capacity = SDL_max( capacity, 64 );
+    LTextureFree( &lTextLabel->mTexture );
+    lTextLabel->mTexture.mTexture =
+        SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_ARGB8888,
+                           SDL_TEXTUREACCESS_STREAMING, capacity, height );
+    if ( lTextLabel->mTexture.mTexture == NULL ) {
+      printf( "Unable to create label texture! SDL Error: %s\n",
+              SDL_GetError() );
+      lTextLabel->mRunCount = 0;
+      return false;
+    }
+    SDL_SetTextureBlendMode( lTextLabel->mTexture.mTexture,
+                             SDL_BLENDMODE_BLEND );
+    LMemoryTrackTexture( lTextLabel->mTexture.mTexture, "LTextLabel" );
+    lTextLabel->mTexture.mWidth = capacity;
+    lTextLabel->mTexture.mHeight = height;
+    lTextLabel->mFont = gFont;
+    lTextLabel->mColor = textColor;
+    lTextLabel->mHeight = height;
+    LTextLabelClear( lTextLabel, 0, capacity );
+
+    // New texture holds nothing yet
+    lTextLabel->mRunCount = 0;
+    for ( int i = 0; i < runCount; ++i ) {
+      lTextLabel->mReused[i] = false;
+    }
+  }
+
+  // Clear what's left of replaced runs, then draw changed ones
+  for ( int i = 0; i < lTextLabel->mRunCount; ++i ) {
+    if ( !lTextLabel->mKept[i] ) {
+      LTextLabelClear( lTextLabel, lTextLabel->mRuns[i].mX,
+                       lTextLabel->mRuns[i].mWidth );
+    }
+  }
+  for ( int i = 0; i < runCount; ++i ) {
+    if ( !lTextLabel->mReused[i] ) {
+      LTextLabelUploadRun( lTextLabel, lTextLabel->mNextText,
+                           &lTextLabel->mNextRuns[i] );
+    }
+  }
+
+  // Keep new layout, the old buffers take the next update
+  char* oldText = lTextLabel->mText;
+  LTextRun* oldRuns = lTextLabel->mRuns;
+  lTextLabel->mText = lTextLabel->mNextText;
+  lTextLabel->mRuns = lTextLabel->mNextRuns;
+  lTextLabel->mNextText = oldText;
+  lTextLabel->mNextRuns = oldRuns;
+  lTextLabel->mRunCount = runCount;
+  lTextLabel->mWidth = width;
+
+  return true;
+}
+
+void LTextLabelRender( LTextLabel* lTextLabel, SDL_Renderer* gRenderer, int x,
+                       int y ) {
+  if ( lTextLabel->mTexture.mTexture == NULL || lTextLabel->mWidth == 0 ) {
+    return;
+  }
+
+  // Only the used part of the texture holds text
+  SDL_Rect clip = { 0, 0, lTextLabel->mWidth, lTextLabel->mHeight };
+  LTextureRender( &lTextLabel->mTexture, gRenderer, x, y, &clip, 0, NULL,
+                  SDL_FLIP_NONE );
+}
@@ -0,0 +1,213 @@
+#ifndef LTEXTURE_REGISTRY_H
+#define LTEXTURE_REGISTRY_H
+
+#include "LTexture.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Image decoded once and kept in memory
+typedef struct LTextureImage LTextureImage;
+
+// Texture of a registered image on one renderer
+typedef struct LTextureEntry LTextureEntry;
+
+// Registry handing out one LTexture per (image file, renderer)
+// Each file is decoded once into a surface every renderer shares, and a
+// renderer's texture is uploaded from that surface the first time it asks,
+// so another window or view costs an upload rather than another decode
+typedef struct LTextureRegistry LTextureRegistry;
+
+// creates empty LTextureRegistry
+LTextureRegistry LTextureRegistryNew( void );
+
+// Frees all textures and decoded images
+void LTextureRegistryFree( LTextureRegistry* lTextureRegistry );
+
+// Returns texture of image at path for renderer, owned by the registry
+LTexture* LTextureRegistryGet( LTextureRegistry* lTextureRegistry,
+                               SDL_Renderer* gRenderer, const char* path );
+
+// Frees renderer's textures, call before destroying the renderer
+void LTextureRegistryForgetRenderer( LTextureRegistry* lTextureRegistry,
+                                     SDL_Renderer* gRenderer );
+
+// Prints decodes, uploads and lookups served from memory
+void LTextureRegistryPrintStats( LTextureRegistry* lTextureRegistry );
+
+typedef struct LTextureImage {
+  char* mPath;
+
+  // Color keyed pixels every renderer uploads from
+  SDL_Surface* mSurface;
+} LTextureImage;
+
+typedef struct LTextureEntry {
+  // Index of image in registry
+  int mImage;
+  SDL_Renderer* mRenderer;
+
+  // Allocated on its own so it doesn't move as entries are added
+  LTexture* mTexture;
+} LTextureEntry;
+
+typedef struct LTextureRegistry {
+  LTextureImage* mImages;
+  int mImageCount;
+
+  LTextureEntry* mTextures;
+  int mTextureCount;
+
+  // Whether textures are uploaded with mip chains, set before the first Get
+  bool mMipmapped;
+
+  // Images decoded, textures uploaded and lookups that found a texture
+  int mDecodes;
+  int mUploads;
+  int mHits;
+} LTextureRegistry;
+
+LTextureRegistry LTextureRegistryNew() {
+  LTextureRegistry lTextureRegistry = { NULL, 0, NULL, 0, false, 0, 0, 0 };
+  return lTextureRegistry;
+}
+
+// Frees entry's texture
+static void LTextureRegistryFreeEntry( LTextureEntry* entry ) {
+  LTextureFree( entry->mTexture );
+  free( entry->mTexture );
+  entry->mTexture = NULL;
+}
+
+void LTextureRegistryFree( LTextureRegistry* lTextureRegistry ) {
+  for ( int i = 0; i < lTextureRegistry->mTextureCount; ++i ) {
+    LTextureRegistryFreeEntry( &lTextureRegistry->mTextures[i] );
+  }
+  free( lTextureRegistry->mTextures );
+
+  for ( int i = 0; i < lTextureRegistry->mImageCount; ++i ) {
+    LTextureImage* image = &lTextureRegistry->mImages[i];
+    LMemoryUntrack( image->mSurface );
+    SDL_FreeSurface( image->mSurface );
+    free( image->mPath );
+  }
+  free( lTextureRegistry->mImages );
+
+  bool mipmapped = lTextureRegistry->mMipmapped;
+  *lTextureRegistry = LTextureRegistryNew();
+  lTextureRegistry->mMipmapped = mipmapped;
+}
+
+// Decodes image at path into image
+static bool LTextureRegistryLoadImage( LTextureImage* image,
+                                       const char* path ) {
+  image->mPath = (char*)malloc( strlen( path ) + 1 );
+  if ( image->mPath == NULL ) {
+    printf( "Unable to allocate image path!\n" );
+    return false;
+  }
+  strcpy( image->mPath, path );
+
+  image->mSurface = LTextureDecodeFile( path );
+  if ( image->mSurface == NULL ) {
+    free( image->mPath );
+    return false;
+  }
+  return true;
+}
+
+LTexture* LTextureRegistryGet( LTextureRegistry* lTextureRegistry,
+                               SDL_Renderer* gRenderer, const char* path ) {
+  // Find decoded image
+  int imageIndex = -1;
+  for ( int i = 0; i < lTextureRegistry->mImageCount; ++i ) {
+    if ( strcmp( lTextureRegistry->mImages[i].mPath, path ) == 0 ) {
+      imageIndex = i;
+      break;
+    }
+  }
+
+  // Reuse texture uploaded before
+  for ( int i = 0; imageIndex >= 0 && i < lTextureRegistry->mTextureCount;
+        ++i ) {
+    LTextureEntry* entry = &lTextureRegistry->mTextures[i];
+    if ( entry->mImage == imageIndex && entry->mRenderer == gRenderer ) {
+      ++lTextureRegistry->mHits;
+      return entry->mTexture;
+    }
+  }
+
+  // Decode image on first use
+  if ( imageIndex < 0 ) {
+    LTextureImage* images = (LTextureImage*)realloc(
+        lTextureRegistry->mImages,
+        sizeof( LTextureImage ) *
+            (size_t)( lTextureRegistry->mImageCount + 1 ) );
+    if ( images == NULL ) {
+      printf( "Unable to allocate image!\n" );
+      return NULL;
+    }
+    lTextureRegistry->mImages = images;
+    if ( !LTextureRegistryLoadImage( &images[lTextureRegistry->mImageCount],
+                                     path ) ) {
+      return NULL;
+    }
+    imageIndex = lTextureRegistry->mImageCount++;
+    ++lTextureRegistry->mDecodes;
+  }
+
+  // Upload shared pixels for this renderer
+  LTextureEntry* textures = (LTextureEntry*)realloc(
+      lTextureRegistry->mTextures,
+      sizeof( LTextureEntry ) *
+          (size_t)( lTextureRegistry->mTextureCount + 1 ) );
+  if ( textures == NULL ) {
+    printf( "Unable to allocate texture entry!\n" );
+    return NULL;
+  }
+  lTextureRegistry->mTextures = textures;
+
+  LTexture* texture = (LTexture*)malloc( sizeof( LTexture ) );
+  if ( texture == NULL ) {
+    printf( "Unable to allocate texture!\n" );
+    return NULL;
+  }
+  *texture = LTextureNew();
+  LTextureSetMipmapped( texture, lTextureRegistry->mMipmapped );
+  LTextureImage* image = &lTextureRegistry->mImages[imageIndex];
+  if ( !LTextureLoadFromSurface( texture, gRenderer, image->mSurface,
+                                 image->mPath ) ) {
+    free( texture );
+    return NULL;
+  }
+  ++lTextureRegistry->mUploads;
+
+  LTextureEntry* entry = &textures[lTextureRegistry->mTextureCount++];
+  entry->mImage = imageIndex;
+  entry->mRenderer = gRenderer;
+  entry->mTexture = texture;
+  return texture;
+}
+
+void LTextureRegistryForgetRenderer( LTextureRegistry* lTextureRegistry,
+                                     SDL_Renderer* gRenderer ) {
+  // Keep the other renderers' entries in order
+  int kept = 0;
+  for ( int i = 0; i < lTextureRegistry->mTextureCount; ++i ) {
+    LTextureEntry* entry = &lTextureRegistry->mTextures[i];
+    if ( entry->mRenderer == gRenderer ) {
+      LTextureRegistryFreeEntry( entry );
+    } else {
+      lTextureRegistry->mTextures[kept++] = *entry;
+    }
+  }
+  lTextureRegistry->mTextureCount = kept;
+}
+
+void LTextureRegistryPrintStats( LTextureRegistry* lTextureRegistry ) {
+  printf( "Texture registry: %d images decoded, %d textures uploaded, "
+          "%d lookups reused a texture\n",
+          lTextureRegistry->mDecodes, lTextureRegistry->mUploads,
+          lTextureRegistry->mHits );
+}
+
+#endif
@@ -0,0 +1,185 @@
+// Include after LTexture.h, which has no include guard
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Sprite batch struct
+// Collects copies of one texture, each with its own tint and alpha carried
+// in the vertex colors, and draws them with a single SDL_RenderGeometry call.
+// Vertex colors modulate texels like SDL_SetTextureColorMod and
+// SDL_SetTextureAlphaMod, so the texture's own modulation is set to white for
+// the batch and restored afterwards to keep it from applying twice
+// SDL_RenderGeometry needs SDL 2.0.18 or newer
+typedef struct LSpriteBatch LSpriteBatch;
+
+// creates LSpriteBatch with default values
+LSpriteBatch LSpriteBatchNew( void );
+
+// Deallocates LSpriteBatch
+void LSpriteBatchFree( LSpriteBatch* lSpriteBatch );
+
+// Allocates room for capacity sprites, more than that are drawn in parts
+bool LSpriteBatchCreate( LSpriteBatch* lSpriteBatch, int capacity );
+
+// Starts batch of sprites from texture
+void LSpriteBatchBegin( LSpriteBatch* lSpriteBatch, LTexture* lTexture,
+                        SDL_Renderer* gRenderer );
+
+// Adds clip of texture stretched over destination, whole texture if clip is
+// NULL, tinted by tint's color and faded by its alpha
+void LSpriteBatchDraw( LSpriteBatch* lSpriteBatch, SDL_Rect* clip,
+                       SDL_Rect* destination, SDL_Color tint );
+
+// Draws sprites added since begin and restores texture modulation
+void LSpriteBatchEnd( LSpriteBatch* lSpriteBatch );
+
+typedef struct LSpriteBatch {
+  // Four vertices and six indices per sprite
+  SDL_Vertex* mVertices;
+  int* mIndices;
+  int mCount;
+  int mCapacity;
+
+  // Texture and renderer of the current batch
+  LTexture* mTexture;
+  SDL_Renderer* mRenderer;
+
+  // Texture modulation to restore at end
+  Uint8 mRed;
+  Uint8 mGreen;
+  Uint8 mBlue;
+  Uint8 mAlpha;
+
+  // Geometry calls made, one per batch unless it overflowed
+  int mDrawCalls;
+} LSpriteBatch;
+
+LSpriteBatch LSpriteBatchNew() {
+  LSpriteBatch lSpriteBatch = { NULL, NULL, 0,    0,    NULL,
+                                NULL, 0xFF, 0xFF, 0xFF, 0xFF, 0 };
+  return lSpriteBatch;
+}
+
+void LSpriteBatchFree( LSpriteBatch* lSpriteBatch ) {
+  free( lSpriteBatch->mVertices );
+  free( lSpriteBatch->mIndices );
+  *lSpriteBatch = LSpriteBatchNew();
+}
+
+bool LSpriteBatchCreate( LSpriteBatch* lSpriteBatch, int capacity ) {
+  // Get rid of preexisting batch
+  LSpriteBatchFree( lSpriteBatch );
+
+  lSpriteBatch->mVertices =
+      (SDL_Vertex*)malloc( sizeof( SDL_Vertex ) * 4 * (size_t)capacity );
+  lSpriteBatch->mIndices =
+      (int*)malloc( sizeof( int ) * 6 * (size_t)capacity );
+  if ( lSpriteBatch->mVertices == NULL || lSpriteBatch->mIndices == NULL ) {
+    printf( "Unable to allocate batch of %d sprites!\n", capacity );
+    LSpriteBatchFree( lSpriteBatch );
+    return false;
+  }
+
+  // Two triangles per quad, the same for every batch
+  for ( int i = 0; i < capacity; ++i ) {
+    int* indices = &lSpriteBatch->mIndices[i * 6];
+    indices[0] = i * 4;
+    indices[1] = i * 4 + 1;
+    indices[2] = i * 4 + 2;
+    indices[3] = i * 4 + 2;
+    indices[4] = i * 4 + 3;
+    indices[5] = i * 4;
+  }
+  lSpriteBatch->mCapacity = capacity;
+  return true;
+}
+
+void LSpriteBatchBegin( LSpriteBatch* lSpriteBatch, LTexture* lTexture,
+                        SDL_Renderer* gRenderer ) {
+  lSpriteBatch->mTexture = lTexture;
+  lSpriteBatch->mRenderer = gRenderer;
+  lSpriteBatch->mCount = 0;
+
+  // Tint comes from the vertices alone while batching
+  SDL_GetTextureColorMod( lTexture->mTexture, &lSpriteBatch->mRed,
+                          &lSpriteBatch->mGreen, &lSpriteBatch->mBlue );
+  SDL_GetTextureAlphaMod( lTexture->mTexture, &lSpriteBatch->mAlpha );
+  SDL_SetTextureColorMod( lTexture->mTexture, 0xFF, 0xFF, 0xFF );
+  SDL_SetTextureAlphaMod( lTexture->mTexture, 0xFF );
+}
+
+// Draws queued sprites and empties batch
+static void LSpriteBatchFlush( LSpriteBatch* lSpriteBatch ) {
+  if ( lSpriteBatch->mCount == 0 ) {
+    return;
+  }
+  ++lSpriteBatch->mDrawCalls;
+  if ( SDL_RenderGeometry( lSpriteBatch->mRenderer,
+                           lSpriteBatch->mTexture->mTexture,
+                           lSpriteBatch->mVertices, lSpriteBatch->mCount * 4,
+                           lSpriteBatch->mIndices,
+                           lSpriteBatch->mCount * 6 ) != 0 ) {
+    printf( "Failed to render sprite batch! SDL Error: %s\n", SDL_GetError() );
+  }
+  lSpriteBatch->mCount = 0;
+}
+
+void LSpriteBatchDraw( LSpriteBatch* lSpriteBatch, SDL_Rect* clip,
+                       SDL_Rect* destination, SDL_Color tint ) {
+  if ( lSpriteBatch->mCount == lSpriteBatch->mCapacity ) {
+    LSpriteBatchFlush( lSpriteBatch );
+    if ( lSpriteBatch->mCapacity == 0 ) {
+      return;
+    }
+  }
+
+  // Texture coordinates of clip, as SDL_RenderCopy maps them
+  LTexture* lTexture = lSpriteBatch->mTexture;
+  SDL_Rect source = { 0, 0, lTexture->mWidth, lTexture->mHeight };
+  if ( clip != NULL ) {
+    source = *clip;
+  }
+  float left = (float)source.x / (float)lTexture->mWidth;
+  float top = (float)source.y / (float)lTexture->mHeight;
+  float right = (float)( source.x + source.w ) / (float)lTexture->mWidth;
+  float bottom = (float)( source.y + source.h ) / (float)lTexture->mHeight;
+
+  SDL_Vertex* vertices = &lSpriteBatch->mVertices[lSpriteBatch->mCount * 4];
+  float x0 = (float)destination->x;
+  float y0 = (float)destination->y;
+  float x1 = (float)( destination->x + destination->w );
+  float y1 = (float)( destination->y + destination->h );
+  vertices[0].position.x = x0;
+  vertices[0].position.y = y0;
+  vertices[0].tex_coord.x = left;
+  vertices[0].tex_coord.y = top;
+  vertices[1].position.x = x1;
+  vertices[1].position.y = y0;
+  vertices[1].tex_coord.x = right;
+  vertices[1].tex_coord.y = top;
+  vertices[2].position.x = x1;
+  vertices[2].position.y = y1;
+  vertices[2].tex_coord.x = right;
+  vertices[2].tex_coord.y = bottom;
+  vertices[3].position.x = x0;
+  vertices[3].position.y = y1;
+  vertices[3].tex_coord.x = left;
+  vertices[3].tex_coord.y = bottom;
+  for ( int corner = 0; corner < 4; ++corner ) {
+    vertices[corner].color = tint;
+  }
+  ++lSpriteBatch->mCount;
+}
+
+void LSpriteBatchEnd( LSpriteBatch* lSpriteBatch ) {
+  LSpriteBatchFlush( lSpriteBatch );
+
+  // Give texture its own modulation back
+  SDL_Texture* texture = lSpriteBatch->mTexture->mTexture;
+  SDL_SetTextureColorMod( texture, lSpriteBatch->mRed, lSpriteBatch->mGreen,
+                          lSpriteBatch->mBlue );
+  SDL_SetTextureAlphaMod( texture, lSpriteBatch->mAlpha );
+  lSpriteBatch->mTexture = NULL;
+  lSpriteBatch->mRenderer = NULL;
+}
@@ -0,0 +1,293 @@
+#ifndef LSURFACE_POOL_H
+#define LSURFACE_POOL_H
+
+#include "LMemory.h"
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Smallest pixel buffer handed out, smaller requests share this class
+#define LSURFACE_POOL_MIN_CLASS 12
+
+// Number of power of two size classes above the smallest
+#define LSURFACE_POOL_CLASSES 20
+
+// Pooled pixel buffer and the surface header last made over it
+typedef struct LSurfacePoolEntry LSurfacePoolEntry;
+
+// Pool of reusable surfaces bucketed by power of two pixel buffer size
+// Releasing a surface keeps its buffer and header, so loading an image of
+// the same size and format again reuses both and a different size within the
+// class only needs a new header. Anything the pool can't describe, like
+// palettized formats, falls back to SDL_CreateRGBSurfaceWithFormat. Pooled
+// buffers are tracked in LMemory from creation until freed, idle or not
+typedef struct LSurfacePool LSurfacePool;
+
+// creates empty LSurfacePool
+LSurfacePool LSurfacePoolNew( void );
+
+// Frees every pooled buffer, surfaces still acquired become invalid
+void LSurfacePoolFree( LSurfacePool* lSurfacePool );
+
+// Returns surface of given size and pixel format, contents are undefined
+SDL_Surface* LSurfacePoolAcquire( LSurfacePool* lSurfacePool, int width,
+                                  int height, Uint32 format );
+
+// Returns surface of given size and pixel format with every pixel zero
+// Only buffers that were handed out before need clearing
+SDL_Surface* LSurfacePoolAcquireZeroed( LSurfacePool* lSurfacePool, int width,
+                                        int height, Uint32 format );
+
+// Gives surface back to the pool, or frees it if the pool didn't make it
+void LSurfacePoolRelease( LSurfacePool* lSurfacePool, SDL_Surface* surface );
+
+// Frees idle buffers until at most maxIdleBytes stay pooled
+void LSurfacePoolTrim( LSurfacePool* lSurfacePool, size_t maxIdleBytes );
+
+// Prints hit rate and pooled memory
+void LSurfacePoolPrintStats( LSurfacePool* lSurfacePool );
+
+typedef struct LSurfacePoolEntry {
+  // Pixel buffer sized to its whole class
+  void* mPixels;
+  int mClass;
+
+  // Header over the buffer, kept while idle for exact reuse
+  SDL_Surface* mSurface;
+  bool mInUse;
+
+  // Buffer was never handed out, so it still holds the zeros it got
+  bool mZeroed;
+} LSurfacePoolEntry;
+
+typedef struct LSurfacePool {
+  LSurfacePoolEntry* mEntries;
+  int mEntryCount;
+
+  // Requests served with buffer and header, buffer only, or neither
+  Uint64 mHits;
+  Uint64 mBufferHits;
+  Uint64 mMisses;
+} LSurfacePool;
+
+LSurfacePool LSurfacePoolNew() {
+  LSurfacePool lSurfacePool;
+  memset( &lSurfacePool, 0, sizeof( lSurfacePool ) );
+  return lSurfacePool;
+}
+
+// Bytes held by buffers of size class
+static size_t LSurfacePoolClassBytes( int sizeClass ) {
+  return (size_t)1 << ( LSURFACE_POOL_MIN_CLASS + sizeClass );
+}
+
+// Drops entry's header and buffer
+static void LSurfacePoolFreeEntry( LSurfacePoolEntry* entry ) {
+  LMemoryUntrack( entry->mPixels );
+  SDL_FreeSurface( entry->mSurface );
+  SDL_free( entry->mPixels );
+  entry->mSurface = NULL;
+  entry->mPixels = NULL;
+}
+
+void LSurfacePoolFree( LSurfacePool* lSurfacePool ) {
+  for ( int i = 0; i < lSurfacePool->mEntryCount; ++i ) {
+    LSurfacePoolFreeEntry( &lSurfacePool->mEntries[i] );
+  }
+  free( lSurfacePool->mEntries );
+  *lSurfacePool = LSurfacePoolNew();
+}
+
+// Hands out surface and the entry backing it, NULL entry for fallbacks
+static SDL_Surface* LSurfacePoolTake( LSurfacePool* lSurfacePool, int width,
+                                      int height, Uint32 format,
+                                      LSurfacePoolEntry** taken ) {
+  *taken = NULL;
+
+  // Size class holding a 4 byte aligned pitch times height
+  int bytesPerPixel = SDL_BYTESPERPIXEL( format );
+  int pitch = ( width * bytesPerPixel + 3 ) & ~3;
+  size_t bytes = (size_t)pitch * (size_t)height;
+  int sizeClass = 0;
+  while ( sizeClass < LSURFACE_POOL_CLASSES &&
+          LSurfacePoolClassBytes( sizeClass ) < bytes ) {
+    ++sizeClass;
+  }
+  if ( SDL_ISPIXELFORMAT_INDEXED( format ) || bytesPerPixel == 0 ||
+       sizeClass == LSURFACE_POOL_CLASSES ) {
+    ++lSurfacePool->mMisses;
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(
+        0, width, height, SDL_BITSPERPIXEL( format ), format );
+    LMemoryTrackSurface( surface, "LSurfacePool" );
+    return surface;
+  }
+
+  // Prefer idle entry whose header already matches
+  LSurfacePoolEntry* entry = NULL;
+  for ( int i = 0; i < lSurfacePool->mEntryCount; ++i ) {
+    LSurfacePoolEntry* candidate = &lSurfacePool->mEntries[i];
+    if ( candidate->mInUse || candidate->mClass != sizeClass ) {
+      continue;
+    }
+    entry = candidate;
+    SDL_Surface* header = candidate->mSurface;
+    if ( header != NULL && header->w == width && header->h == height &&
+         header->format->format == format ) {
+      break;
+    }
+  }
+
+  if ( entry == NULL ) {
+    // Grow pool with a new buffer
+    size_t entryCount = (size_t)lSurfacePool->mEntryCount + 1;
+    LSurfacePoolEntry* entries = (LSurfacePoolEntry*)realloc(
+        lSurfacePool->mEntries, sizeof( LSurfacePoolEntry ) * entryCount );
+    if ( entries == NULL ) {
+      printf( "Unable to grow surface pool!\n" );
+      return NULL;
+    }
+    lSurfacePool->mEntries = entries;
+    entry = &entries[lSurfacePool->mEntryCount];
+    memset( entry, 0, sizeof( LSurfacePoolEntry ) );
+    entry->mPixels = SDL_calloc( 1, LSurfacePoolClassBytes( sizeClass ) );
+    if ( entry->mPixels == NULL ) {
+      printf( "Unable to allocate pooled surface!\n" );
+      return NULL;
+    }
+    entry->mClass = sizeClass;
+    entry->mZeroed = true;
+
+    // Buffers outlive the surfaces over them and serve any format
+    LMemoryTrackBuffer( entry->mPixels, "LSurfacePool",
+                        SDL_PIXELFORMAT_UNKNOWN,
+                        LSurfacePoolClassBytes( sizeClass ) );
+    ++lSurfacePool->mEntryCount;
+    ++lSurfacePool->mMisses;
+  } else if ( entry->mSurface != NULL && entry->mSurface->w == width &&
+              entry->mSurface->h == height &&
+              entry->mSurface->format->format == format ) {
+    // Whole surface reused, reset state a previous user may have changed
+    SDL_SetColorKey( entry->mSurface, SDL_FALSE, 0 );
+    SDL_SetSurfaceBlendMode( entry->mSurface,
+                             SDL_ISPIXELFORMAT_ALPHA( format )
+                                 ? SDL_BLENDMODE_BLEND
+                                 : SDL_BLENDMODE_NONE );
+    SDL_SetSurfaceColorMod( entry->mSurface, 0xFF, 0xFF, 0xFF );
+    SDL_SetSurfaceAlphaMod( entry->mSurface, 0xFF );
+    SDL_SetClipRect( entry->mSurface, NULL );
+    entry->mInUse = true;
+    ++lSurfacePool->mHits;
+    *taken = entry;
+    return entry->mSurface;
+  } else {
+    ++lSurfacePool->mBufferHits;
+  }
+
+  // Describe buffer with a header for the requested shape
+  SDL_FreeSurface( entry->mSurface );
+  entry->mSurface = SDL_CreateRGBSurfaceWithFormatFrom(
+      entry->mPixels, width, height, SDL_BITSPERPIXEL( format ), pitch,
+      format );
+  if ( entry->mSurface == NULL ) {
+    printf( "Unable to create pooled surface! SDL Error: %s\n",
+            SDL_GetError() );
+    return NULL;
+  }
+  entry->mInUse = true;
+  *taken = entry;
+  return entry->mSurface;
+}
+
+SDL_Surface* LSurfacePoolAcquire( LSurfacePool* lSurfacePool, int width,
+                                  int height, Uint32 format ) {
+  LSurfacePoolEntry* entry;
+  SDL_Surface* surface =
+      LSurfacePoolTake( lSurfacePool, width, height, format, &entry );
+  if ( entry != NULL ) {
+    entry->mZeroed = false;
+  }
+  return surface;
+}
+
+SDL_Surface* LSurfacePoolAcquireZeroed( LSurfacePool* lSurfacePool, int width,
+                                        int height, Uint32 format ) {
+  // Fallback surfaces come zeroed from SDL
+  LSurfacePoolEntry* entry;
+  SDL_Surface* surface =
+      LSurfacePoolTake( lSurfacePool, width, height, format, &entry );
+  if ( entry != NULL && !entry->mZeroed ) {
+    SDL_memset( surface->pixels, 0,
+                (size_t)surface->pitch * (size_t)surface->h );
+  }
+  if ( entry != NULL ) {
+    entry->mZeroed = false;
+  }
+  return surface;
+}
+
+void LSurfacePoolRelease( LSurfacePool* lSurfacePool, SDL_Surface* surface ) {
+  if ( surface == NULL ) {
+    return;
+  }
+  for ( int i = 0; i < lSurfacePool->mEntryCount; ++i ) {
+    if ( lSurfacePool->mEntries[i].mSurface == surface ) {
+      lSurfacePool->mEntries[i].mInUse = false;
+      return;
+    }
+  }
+
+  // Fallback surface not backed by the pool
+  LMemoryUntrack( surface );
+  SDL_FreeSurface( surface );
+}
+
+void LSurfacePoolTrim( LSurfacePool* lSurfacePool, size_t maxIdleBytes ) {
+  size_t idleBytes = 0;
+  for ( int i = 0; i < lSurfacePool->mEntryCount; ++i ) {
+    if ( !lSurfacePool->mEntries[i].mInUse ) {
+      idleBytes += LSurfacePoolClassBytes( lSurfacePool->mEntries[i].mClass );
+    }
+  }
+
+  // Free largest idle buffers first, compacting entries in place
+  for ( int sizeClass = LSURFACE_POOL_CLASSES - 1;
+        sizeClass >= 0 && idleBytes > maxIdleBytes; --sizeClass ) {
+    int kept = 0;
+    for ( int i = 0; i < lSurfacePool->mEntryCount; ++i ) {
+      LSurfacePoolEntry* entry = &lSurfacePool->mEntries[i];
+      if ( !entry->mInUse && entry->mClass == sizeClass &&
+           idleBytes > maxIdleBytes ) {
+        idleBytes -= LSurfacePoolClassBytes( sizeClass );
+        LSurfacePoolFreeEntry( entry );
+      } else {
+        lSurfacePool->mEntries[kept++] = *entry;
+      }
+    }
+    lSurfacePool->mEntryCount = kept;
+  }
+}
+
+void LSurfacePoolPrintStats( LSurfacePool* lSurfacePool ) {
+  Uint64 requests =
+      lSurfacePool->mHits + lSurfacePool->mBufferHits + lSurfacePool->mMisses;
+  size_t pooledBytes = 0;
+  for ( int i = 0; i < lSurfacePool->mEntryCount; ++i ) {
+    pooledBytes += LSurfacePoolClassBytes( lSurfacePool->mEntries[i].mClass );
+  }
+  printf( "Surface pool: %llu requests, %llu hits, %llu buffer hits, "
+          "%llu misses (%.1f%% hit rate), %lu bytes pooled\n",
+          (unsigned long long)requests,
+          (unsigned long long)lSurfacePool->mHits,
+          (unsigned long long)lSurfacePool->mBufferHits,
+          (unsigned long long)lSurfacePool->mMisses,
+          requests > 0 ? 100.0 *
+                             (double)( lSurfacePool->mHits +
+                                       lSurfacePool->mBufferHits ) /
+                             (double)requests
+                       : 0.0,
+          (unsigned long)pooledBytes );
+}
+
+#endif
@@ -0,0 +1,546 @@
+#ifndef LTEXTURE_H
+#define LTEXTURE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2_Image/SDL_image.h>
+#include <SDL2_ttf/SDL_ttf.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "LMemory.h"
+#include "LSurfacePool.h"
+#include "LTrace.h"
+#if defined( __SSE2__ ) || defined( _M_X64 )
+#include <emmintrin.h>
+#define LTEXTURE_SSE2
+#endif
+
+// Most mip levels below full size, enough to take 4096 pixels down to 1
+#define LTEXTURE_MAX_MIPS 12
+
+// Texture wrapper struct
+typedef struct LTexture LTexture;
+
+// creates LTexture with default values
+LTexture LTextureNew( void );
+
+// Deallocates LTexture
+void LTextureFree( LTexture* lTexture );
+
+// Loads image at specified path for LTexture
+bool LTextureLoadFromFile( LTexture* lTexture, SDL_Renderer* gRenderer,
+                           char* path );
+
+// Creates texture from decoded surface, accounted to owner
+// The surface stays with the caller, so one decoded image can feed textures
+// on several renderers
+bool LTextureLoadFromSurface( LTexture* lTexture, SDL_Renderer* gRenderer,
+                              SDL_Surface* surface, const char* owner );
+
+// Creates image from font string
+bool LTextureLoadFromRenderedText( LTexture* lTexture, SDL_Renderer* gRenderer,
+                                   TTF_Font* gFont, char* textureText,
+                                   SDL_Color textColor );
+
+// Renders texture at given point
+void LTextureRender( LTexture* lTexture, SDL_Renderer* gRenderer, int x, int y,
+                     SDL_Rect* clip, double angle, SDL_Point* center,
+                     SDL_RendererFlip flip );
+
+// Makes later loads build a chain of half size copies, call before loading
+// Mipmapped textures are filtered linearly however the scale hint is set
+void LTextureSetMipmapped( LTexture* lTexture, bool mipmapped );
+
+// Renders clip (whole texture if NULL) stretched over destination
+// Minified draws read the smallest mip level still covering destination
+void LTextureRenderScaled( LTexture* lTexture, SDL_Renderer* gRenderer,
+                           SDL_Rect* clip, SDL_Rect* destination, double angle,
+                           SDL_Point* center, SDL_RendererFlip flip );
+
+// Frees staging surfaces kept between loads
+void LTextureFreeStaging( void );
+
+// Frees idle staging surfaces until at most maxIdleBytes stay pooled
+void LTextureTrimStaging( size_t maxIdleBytes );
+
+// Prints how often loads reused staging surfaces
+void LTexturePrintStagingStats( void );
+
+// Set color modulation
+bool LTextureSetColor( LTexture* lTexture, Uint8 red, Uint8 green, Uint8 blue );
+
+// Set blending
+void LTextureSetBlendMode( LTexture* lTexture, SDL_BlendMode blending );
+
+// Set alpha modulation
+void LTextureSetAlpha( LTexture* lTexture, Uint8 alpha );
+
+typedef struct LTexture {
+  // The actual hardware texture
+  SDL_Texture* mTexture;
+
+  // Image dimensions
+  int mWidth;
+  int mHeight;
+
+  // Whether uploads build mips, and the levels from half size down
+  bool mMipmapped;
+  SDL_Texture* mMips[LTEXTURE_MAX_MIPS];
+  int mMipCount;
+} LTexture;
+
+// Staging surfaces in the renderer's native format, reused between loads
+static LSurfacePool gLTextureStagingPool;
+
+// Renderer the native format was chosen for
+static SDL_Renderer* gLTextureNativeRenderer = NULL;
+static Uint32 gLTextureNativeFormat = SDL_PIXELFORMAT_UNKNOWN;
+
+// Render calls made through any LTexture, read by metrics
+// Atomic since renderers on different threads draw at once
+static SDL_atomic_t gLTextureDrawCalls;
+
+LTexture LTextureNew() {
+  LTexture lTexture = { NULL, 0, 0, false, { NULL }, 0 };
+  return lTexture;
+}
+
+void LTextureFree( LTexture* lTexture ) {
+  if ( lTexture->mTexture != NULL ) {
+    LMemoryUntrack( lTexture->mTexture );
+    SDL_DestroyTexture( lTexture->mTexture );
+    lTexture->mTexture = NULL;
+    lTexture->mWidth = 0;
+    lTexture->mHeight = 0;
+  }
+
+  // Keep mipmapped setting for the next load
+  for ( int i = 0; i < lTexture->mMipCount; ++i ) {
+    LMemoryUntrack( lTexture->mMips[i] );
+    SDL_DestroyTexture( lTexture->mMips[i] );
+    lTexture->mMips[i] = NULL;
+  }
+  lTexture->mMipCount = 0;
+}
+
+void LTextureSetMipmapped( LTexture* lTexture, bool mipmapped ) {
+  lTexture->mMipmapped = mipmapped;
+}
+
+void LTextureFreeStaging() {
+  LSurfacePoolFree( &gLTextureStagingPool );
+}
+
+void LTextureTrimStaging( size_t maxIdleBytes ) {
+  LSurfacePoolTrim( &gLTextureStagingPool, maxIdleBytes );
+}
+
+void LTexturePrintStagingStats() {
+  LSurfacePoolPrintStats( &gLTextureStagingPool );
+}
+
+// Picks the first alpha format the renderer supports without conversion
+static Uint32 LTextureNativeFormat( SDL_Renderer* gRenderer ) {
+  if ( gRenderer == gLTextureNativeRenderer ) {
+    return gLTextureNativeFormat;
+  }
+
+  gLTextureNativeRenderer = gRenderer;
+  gLTextureNativeFormat = SDL_PIXELFORMAT_ARGB8888;
+  SDL_RendererInfo info;
+  if ( SDL_GetRendererInfo( gRenderer, &info ) == 0 ) {
+    for ( Uint32 i = 0; i < info.num_texture_formats; ++i ) {
+      Uint32 format = info.texture_formats[i];
+      if ( SDL_ISPIXELFORMAT_ALPHA( format ) &&
+           !SDL_ISPIXELFORMAT_FOURCC( format ) &&
+           !SDL_ISPIXELFORMAT_INDEXED( format ) &&
+           SDL_BYTESPERPIXEL( format ) == 4 ) {
+        gLTextureNativeFormat = format;
+        break;
+      }
+    }
+  }
+  return gLTextureNativeFormat;
+}
+
+// Halves 32 bit pixels with a 2x2 box filter, odd last rows and columns are
+// dropped. Colors are weighted by alpha, as if premultiplied before filtering
+// and divided back after, so transparent texels like keyed backgrounds don't
+// darken the edges next to them. alphaIndex is the byte holding alpha, -1
+// for formats without it. SSE2 filters a pixel's channels at once when alpha
+// comes last in memory, the scalar loop does the same float math so both
+// give identical levels
+static void LTextureDownsample( const Uint8* source, int sourcePitch,
+                                Uint32* destination, int width, int height,
+                                int alphaIndex ) {
+  for ( int y = 0; y < height; ++y ) {
+    const Uint8* top = source + 2 * y * sourcePitch;
+    const Uint8* bottom = top + sourcePitch;
+    Uint8* out = (Uint8*)( destination + y * width );
+    int x = 0;
+
+#ifdef LTEXTURE_SSE2
+    if ( alphaIndex == 3 ) {
+      __m128i zero = _mm_setzero_si128();
+      __m128 alphaLane = _mm_castsi128_ps( _mm_set_epi32( -1, 0, 0, 0 ) );
+      for ( ; x < width; ++x ) {
+        // Widen the 2x2 block to a float vector per texel
+        __m128i topPair = _mm_unpacklo_epi8(
+            _mm_loadl_epi64( (const __m128i*)( top + x * 8 ) ), zero );
+        __m128i bottomPair = _mm_unpacklo_epi8(
+            _mm_loadl_epi64( (const __m128i*)( bottom + x * 8 ) ), zero );
+        __m128 texels[4] = {
+            _mm_cvtepi32_ps( _mm_unpacklo_epi16( topPair, zero ) ),
+            _mm_cvtepi32_ps( _mm_unpackhi_epi16( topPair, zero ) ),
+            _mm_cvtepi32_ps( _mm_unpacklo_epi16( bottomPair, zero ) ),
+            _mm_cvtepi32_ps( _mm_unpackhi_epi16( bottomPair, zero ) ) };
+
+        // Sums stay below 2^24, so they are exact in any order
+        __m128 alpha = _mm_setzero_ps();
+        __m128 sum = _mm_setzero_ps();
+        for ( int i = 0; i < 4; ++i ) {
+          __m128 weight = _mm_shuffle_ps( texels[i], texels[i], 0xFF );
+          alpha = _mm_add_ps( alpha, weight );
+          sum = _mm_add_ps( sum, _mm_mul_ps( texels[i], weight ) );
+        }
+        __m128 color = _mm_add_ps(
+            _mm_div_ps( sum, _mm_max_ps( alpha, _mm_set1_ps( 1.f ) ) ),
+            _mm_set1_ps( 0.5f ) );
+        __m128 coverage =
+            _mm_mul_ps( _mm_add_ps( alpha, _mm_set1_ps( 2.f ) ),
+                        _mm_set1_ps( 0.25f ) );
+        __m128i pixel = _mm_cvttps_epi32(
+            _mm_or_ps( _mm_and_ps( alphaLane, coverage ),
+                       _mm_andnot_ps( alphaLane, color ) ) );
+        pixel = _mm_packs_epi32( pixel, pixel );
+        destination[y * width + x] =
+            (Uint32)_mm_cvtsi128_si32( _mm_packus_epi16( pixel, pixel ) );
+      }
+    }
+#endif
+
+    for ( ; x < width; ++x ) {
+      const Uint8* texels[4] = { top + x * 8, top + x * 8 + 4, bottom + x * 8,
+                                 bottom + x * 8 + 4 };
+      int alpha = 0;
+      int sums[4] = { 0, 0, 0, 0 };
+      for ( int i = 0; i < 4; ++i ) {
+        int weight = alphaIndex >= 0 ? texels[i][alphaIndex] : 1;
+        alpha += weight;
+        for ( int channel = 0; channel < 4; ++channel ) {
+          sums[channel] += texels[i][channel] * weight;
+        }
+      }
+      for ( int channel = 0; channel < 4; ++channel ) {
+        if ( alphaIndex < 0 || channel == alphaIndex ) {
+          int plain = alphaIndex < 0 ? sums[channel] : alpha;
+          out[x * 4 + channel] = (Uint8)( ( plain + 2 ) >> 2 );
+        } else {
+          out[x * 4 + channel] = (Uint8)( (float)sums[channel] /
+                                              (float)SDL_max( alpha, 1 ) +
+                                          0.5f );
+        }
+      }
+    }
+  }
+}
+
+// Uploads successively halved copies of staging as lTexture's mip levels
+static void LTextureBuildMips( LTexture* lTexture, SDL_Renderer* gRenderer,
+                               SDL_Surface* staging, const char* owner ) {
+  // Minified draws should blend texels, not pick one
+  SDL_SetTextureScaleMode( lTexture->mTexture, SDL_ScaleModeLinear );
+
+  const Uint8* source = (const Uint8*)staging->pixels;
+  int sourcePitch = staging->pitch;
+  int width = staging->w;
+  int height = staging->h;
+  Uint32* previous = NULL;
+
+  // Byte of each pixel holding alpha, the same for every level
+  SDL_PixelFormat* format = staging->format;
+  int alphaIndex = -1;
+  if ( format->Amask != 0 ) {
+    alphaIndex = SDL_BYTEORDER == SDL_LIL_ENDIAN ? format->Ashift / 8
+                                                 : 3 - format->Ashift / 8;
+  }
+  while ( lTexture->mMipCount < LTEXTURE_MAX_MIPS && width >= 2 &&
+          height >= 2 ) {
+    width /= 2;
+    height /= 2;
+    Uint32* level =
+        (Uint32*)malloc( sizeof( Uint32 ) * (size_t)width * (size_t)height );
+    if ( level == NULL ) {
+      printf( "Unable to allocate mip level!\n" );
+      break;
+    }
+    LTextureDownsample( source, sourcePitch, level, width, height,
+                        alphaIndex );
+
+    SDL_Texture* texture =
+        SDL_CreateTexture( gRenderer, staging->format->format,
+                           SDL_TEXTUREACCESS_STATIC, width, height );
+    if ( texture == NULL ||
+         SDL_UpdateTexture( texture, NULL, level,
+                            width * (int)sizeof( Uint32 ) ) != 0 ) {
+      printf( "Unable to upload mip level! SDL Error: %s\n", SDL_GetError() );
+      if ( texture != NULL ) {
+        SDL_DestroyTexture( texture );
+      }
+      free( level );
+      break;
+    }
+    SDL_SetTextureBlendMode( texture, SDL_BLENDMODE_BLEND );
+    SDL_SetTextureScaleMode( texture, SDL_ScaleModeLinear );
+    LMemoryTrackTexture( texture, owner );
+    lTexture->mMips[lTexture->mMipCount++] = texture;
+
+    // Next level is filtered from this one
+    free( previous );
+    previous = level;
+    source = (const Uint8*)level;
+    sourcePitch = width * (int)sizeof( Uint32 );
+  }
+  free( previous );
+}
+
+// Uploads surface in the renderer's native format, color key becomes alpha
+// Surfaces already in that format without a key are uploaded straight from
+// their pixels. Anything else is converted once into a reused staging surface
+// and uploaded from there, which replaces the conversion
+// SDL_CreateTextureFromSurface would do on its own. The texture is accounted
+// to owner
+static bool LTextureUpload( LTexture* lTexture, SDL_Renderer* gRenderer,
+                            SDL_Surface* surface, const char* owner ) {
+  Uint32 format = LTextureNativeFormat( gRenderer );
+  SDL_Surface* staging = NULL;
+  SDL_Surface* pixels = surface;
+  if ( surface->format->format != format || SDL_HasColorKey( surface ) ) {
+    // Keyed pixels are skipped by the blit and keep the zeroed transparent
+    // background, without a key every pixel is overwritten
+    staging =
+        SDL_HasColorKey( surface )
+            ? LSurfacePoolAcquireZeroed( &gLTextureStagingPool, surface->w,
+                                         surface->h, format )
+            : LSurfacePoolAcquire( &gLTextureStagingPool, surface->w,
+                                   surface->h, format );
+    if ( staging == NULL ) {
+      return false;
+    }
+
+    SDL_SetSurfaceBlendMode( surface, SDL_BLENDMODE_NONE );
+    if ( SDL_BlitSurface( surface, NULL, staging, NULL ) != 0 ) {
+      printf( "Unable to convert surface! SDL Error: %s\n", SDL_GetError() );
+      LSurfacePoolRelease( &gLTextureStagingPool, staging );
+      return false;
+    }
+    pixels = staging;
+  } else if ( SDL_LockSurface( surface ) != 0 ) {
+    printf( "Unable to lock surface! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  SDL_Texture* newTexture =
+      SDL_CreateTexture( gRenderer, format, SDL_TEXTUREACCESS_STATIC,
+                         surface->w, surface->h );
+  bool success = newTexture != NULL &&
+                 SDL_UpdateTexture( newTexture, NULL, pixels->pixels,
+                                    pixels->pitch ) == 0;
+  if ( !success ) {
+    printf( "Unable to upload texture! SDL Error: %s\n", SDL_GetError() );
+    if ( newTexture != NULL ) {
+      SDL_DestroyTexture( newTexture );
+    }
+  } else {
+    SDL_SetTextureBlendMode( newTexture, SDL_BLENDMODE_BLEND );
+    LMemoryTrackTexture( newTexture, owner );
+
+    lTexture->mTexture = newTexture;
+    lTexture->mWidth = surface->w;
+    lTexture->mHeight = surface->h;
+
+    // Filter levels from the native pixels while they're at hand
+    if ( lTexture->mMipmapped ) {
+      LTextureBuildMips( lTexture, gRenderer, pixels, owner );
+    }
+  }
+
+  if ( staging != NULL ) {
+    LSurfacePoolRelease( &gLTextureStagingPool, staging );
+  } else {
+    SDL_UnlockSurface( surface );
+  }
+  return success;
+}
+
+// Loads image at specified path and color keys it, NULL on failure
+static SDL_Surface* LTextureDecodeFile( const char* path ) {
+  LTraceBeginDetail( "IMG_Load", path );
+  SDL_Surface* loadedSurface = IMG_Load( path );
+  LTraceEnd();
+  if ( loadedSurface == NULL ) {
+    printf( "Unable to load image %s! SDL_image Error: %s\n", path,
+            IMG_GetError() );
+    return NULL;
+  }
+  LMemoryTrackSurface( loadedSurface, path );
+
+  // Color key image
+  if ( SDL_SetColorKey( loadedSurface, SDL_TRUE,
+                        SDL_MapRGB( loadedSurface->format, 0, 0xFF, 0xFF ) ) !=
+       0 ) {
+    printf( "Unable to load image %s! SDL_image Error: %s\n", path,
+            SDL_GetError() );
+    LMemoryUntrack( loadedSurface );
+    SDL_FreeSurface( loadedSurface );
+    return NULL;
+  }
+  return loadedSurface;
+}
+
+bool LTextureLoadFromFile( LTexture* lTexture, SDL_Renderer* gRenderer,
+                           char* path ) {
+  // Get rid of preexisting texture
+  LTextureFree( lTexture );
+
+  // Load image at specified path
+  SDL_Surface* loadedSurface = LTextureDecodeFile( path );
+  if ( loadedSurface == NULL ) {
+    return false;
+  }
+
+  // Create texture in the renderer's own format
+  bool success =
+      LTextureLoadFromSurface( lTexture, gRenderer, loadedSurface, path );
+
+  // Get rid of old loaded surface
+  LMemoryUntrack( loadedSurface );
+  SDL_FreeSurface( loadedSurface );
+
+  return success;
+}
+
+bool LTextureLoadFromSurface( LTexture* lTexture, SDL_Renderer* gRenderer,
+                              SDL_Surface* surface, const char* owner ) {
+  // make pixel art not blurry
+  SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "0" );
+
+  // Get rid of preexisting texture
+  LTextureFree( lTexture );
+
+  // Create texture in the renderer's own format
+  LTraceBeginDetail( "LTextureUpload", owner );
+  bool success = LTextureUpload( lTexture, gRenderer, surface, owner );
+  LTraceEnd();
+  if ( !success ) {
+    printf( "Unable to create texture from %s!\n", owner );
+  }
+  return success;
+}
+
+bool LTextureLoadFromRenderedText( LTexture* lTexture, SDL_Renderer* gRenderer,
+                                   TTF_Font* gFont, char* textureText,
+                                   SDL_Color textColor ) {
+  // Get rid of preexisting texture
+  LTextureFree( lTexture );
+
+  // Render text surface
+  LTraceBeginDetail( "TTF_RenderText_Solid", textureText );
+  SDL_Surface* textSurface =
+      TTF_RenderText_Solid( gFont, textureText, textColor );
+  LTraceEnd();
+  if ( textSurface == NULL ) {
+    printf( "Unable to render text surface! SDL_ttf Error: %s\n",
+            TTF_GetError() );
+  } else {
+    LMemoryTrackSurface( textSurface, textureText );
+
+    // Create texture from surface pixels, background is color keyed
+    if ( !LTextureUpload( lTexture, gRenderer, textSurface, textureText ) ) {
+      printf( "Unable to create texture from rendered text!\n" );
+    }
+
+    // Get rid of old surface
+    LMemoryUntrack( textSurface );
+    SDL_FreeSurface( textSurface );
+  }
+
+  // Return success
+  return lTexture->mTexture != NULL;
+}
+
+void LTextureRender( LTexture* lTexture, SDL_Renderer* gRenderer, int x, int y,
+                     SDL_Rect* clip, double angle, SDL_Point* center,
+                     SDL_RendererFlip flip ) {
+  // Set rendering space and render to screen
+  SDL_Rect renderQuad = { x, y, lTexture->mWidth, lTexture->mHeight };
+
+  // Set clip rendering dimensions
+  if ( clip != NULL ) {
+    renderQuad.w = clip->w;
+    renderQuad.h = clip->h;
+  }
+
+  // Render to screen
+  SDL_AtomicIncRef( &gLTextureDrawCalls );
+  if ( SDL_RenderCopyEx( gRenderer, lTexture->mTexture, clip, &renderQuad,
+                         angle, center, flip ) != 0 ) {
+    printf( "Failed to render texture! SDL Error: %s\n", SDL_GetError() );
+  }
+}
+
+void LTextureRenderScaled( LTexture* lTexture, SDL_Renderer* gRenderer,
+                           SDL_Rect* clip, SDL_Rect* destination, double angle,
+                           SDL_Point* center, SDL_RendererFlip flip ) {
+  SDL_Rect source = { 0, 0, lTexture->mWidth, lTexture->mHeight };
+  if ( clip != NULL ) {
+    source = *clip;
+  }
+
+  // Step down while the next level still covers the destination
+  SDL_Texture* texture = lTexture->mTexture;
+  for ( int level = 0; level < lTexture->mMipCount &&
+                       source.w / 2 >= SDL_max( destination->w, 1 ) &&
+                       source.h / 2 >= SDL_max( destination->h, 1 );
+        ++level ) {
+    source.x /= 2;
+    source.y /= 2;
+    source.w /= 2;
+    source.h /= 2;
+    texture = lTexture->mMips[level];
+  }
+
+  SDL_AtomicIncRef( &gLTextureDrawCalls );
+  if ( SDL_RenderCopyEx( gRenderer, texture, &source, destination, angle,
+                         center, flip ) != 0 ) {
+    printf( "Failed to render texture! SDL Error: %s\n", SDL_GetError() );
+  }
+}
+
+bool LTextureSetColor( LTexture* lTexture, Uint8 red, Uint8 green,
+                       Uint8 blue ) {
+  // Modulate texture
+  if ( SDL_SetTextureColorMod( lTexture->mTexture, red, green, blue ) != 0 ) {
+    printf( "Failed to set color modulation! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+  for ( int i = 0; i < lTexture->mMipCount; ++i ) {
+    SDL_SetTextureColorMod( lTexture->mMips[i], red, green, blue );
+  }
+  return true;
+}
+
+void LTextureSetBlendMode( LTexture* lTexture, SDL_BlendMode blending ) {
+  SDL_SetTextureBlendMode( lTexture->mTexture, blending );
+  for ( int i = 0; i < lTexture->mMipCount; ++i ) {
+    SDL_SetTextureBlendMode( lTexture->mMips[i], blending );
+  }
+}
+
+void LTextureSetAlpha( LTexture* lTexture, Uint8 alpha ) {
+  SDL_SetTextureAlphaMod( lTexture->mTexture, alpha );
+  for ( int i = 0; i < lTexture->mMipCount; ++i ) {
+    SDL_SetTextureAlphaMod( lTexture->mMips[i], alpha );
+  }
+}
+
+#endif
@@ -0,0 +1,481 @@
+// Using SDL, SDL_image, SDL_ttf, standard IO, the tutorial scenes and the job
+// system
+#include "LScenes.h"
+#include "LJobs.h"
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+// Frames one render task draws on its own renderer, ranges are split into
+// tasks of this size so long sequences spread over every core
+const int FRAMES_PER_TASK = 8;
+
+// Rendered frames allowed to wait for encoding, past this the renderer
+// encodes its frame itself so memory stays bounded
+const int MAX_PENDING_FRAMES = 64;
+
+// Most jobs in one batch
+#define MAX_BATCH_JOBS 256
+
+// Longest output path
+#define MAX_PATH_SIZE 256
+
+// Scene frames to render, from a spec like
+// true_type_fonts:0-15:160x120:sheet
+typedef struct BatchJob {
+  const LScene* scene;
+
+  // Inclusive frame range
+  int first;
+  int last;
+
+  // Output size, the scene is scaled to fit
+  int width;
+  int height;
+
+  // Whether frames go into one sprite sheet instead of a PNG each
+  bool sheet;
+  SDL_Surface* sheetSurface;
+  int sheetColumns;
+
+  // Render tasks of this job not yet finished
+  LJobCounter rendered;
+} BatchJob;
+
+// Part of a job's frame range drawn on one renderer
+typedef struct RenderTask {
+  BatchJob* job;
+  int first;
+  int last;
+} RenderTask;
+
+// Surface to write, owned by the task
+typedef struct EncodeTask {
+  SDL_Surface* surface;
+  char path[MAX_PATH_SIZE];
+} EncodeTask;
+
+// Starts up SDL and the workers
+bool init( int workerCount );
+
+// Stops workers and shuts down SDL
+void close( void );
+
+// Fills job from spec, false if it isn't valid
+bool parseJob( const char* spec, BatchJob* job );
+
+// Creates a job's sprite sheet, frames are laid out in a near square grid
+bool createSheet( BatchJob* job );
+
+// Decodes a scene's media once for every render task of that scene
+void decodeTask( void* data );
+
+// Renders frames of a task on a renderer of its own
+void renderTask( void* data );
+
+// Writes surface of an encode task to PNG and frees it
+void encodeTask( void* data );
+
+// Queues surface to be written to path, or writes it now when too many are
+// waiting
+void submitEncode( SDL_Surface* surface, const char* path );
+
+// Queues a job's finished sprite sheet for writing
+void encodeSheet( void* data );
+
+// Work stealing pool running render and encode tasks
+LJobs gJobs;
+
+// Encode tasks not yet finished
+LJobCounter gEncoded;
+
+// Serializes media loading, SDL_ttf and LTexture's upload state are shared
+SDL_mutex* gLoadLock = NULL;
+
+// Media of each scene decoded by its decode task, NULL until then or if it
+// failed, and the counter render tasks of the scene wait on
+SDL_Surface* gSceneMedia[LSCENE_COUNT];
+LJobCounter gSceneDecoded[LSCENE_COUNT];
+bool gSceneQueued[LSCENE_COUNT];
+
+// Where PNGs are written
+const char* gOutputDirectory = "batch_out";
+
+// Frames waiting for encoding, frames rendered, PNGs written and failures
+SDL_atomic_t gPendingFrames;
+SDL_atomic_t gRenderedFrames;
+SDL_atomic_t gWrittenFiles;
+SDL_atomic_t gFailures;
+
+bool init( int workerCount ) {
+  // Initialize SDL
+  if ( SDL_Init( 0 ) < 0 ) {
+    printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  // Initialize PNG loading and saving
+  int imgFlags = IMG_INIT_PNG;
+  if ( !( IMG_Init( imgFlags ) & imgFlags ) ) {
+    printf( "SDL_image could not initialize! SDL_image Error: %s\n",
+            IMG_GetError() );
+    return false;
+  }
+
+  // Initialize SDL_ttf
+  if ( TTF_Init() == -1 ) {
+    printf( "SDL_ttf could not initialize! SDL_ttf Error: %s\n",
+            TTF_GetError() );
+    return false;
+  }
+
+  gLoadLock = SDL_CreateMutex();
+  if ( gLoadLock == NULL ) {
+    printf( "Unable to create load lock! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  gJobs = LJobsNew();
+  gEncoded = LJobCounterNew();
+  for ( int i = 0; i < LSCENE_COUNT; ++i ) {
+    gSceneDecoded[i] = LJobCounterNew();
+  }
+  return LJobsStart( &gJobs, workerCount );
+}
+
+void close() {
+  LJobsFree( &gJobs );
+  for ( int i = 0; i < LSCENE_COUNT; ++i ) {
+    LSceneFreeMedia( gSceneMedia[i] );
+    gSceneMedia[i] = NULL;
+  }
+  LTextureFreeStaging();
+  if ( gLoadLock != NULL ) {
+    SDL_DestroyMutex( gLoadLock );
+    gLoadLock = NULL;
+  }
+
+  // Quit SDL subsystems
+  TTF_Quit();
+  IMG_Quit();
+  SDL_Quit();
+}
+
+bool parseJob( const char* spec, BatchJob* job ) {
+  memset( job, 0, sizeof( BatchJob ) );
+  job->first = 0;
+  job->last = 15;
+  job->width = LSCENE_WIDTH;
+  job->height = LSCENE_HEIGHT;
+  job->rendered = LJobCounterNew();
+
+  // Scene name comes first
+  char copy[MAX_PATH_SIZE];
+  snprintf( copy, sizeof( copy ), "%s", spec );
+  char* part = strtok( copy, ":" );
+  for ( int i = 0; part != NULL && i < LSCENE_COUNT; ++i ) {
+    if ( strcmp( gLScenes[i].mName, part ) == 0 ) {
+      job->scene = &gLScenes[i];
+    }
+  }
+  if ( job->scene == NULL ) {
+    printf( "Unknown scene in %s\n", spec );
+    return false;
+  }
+
+  // Then frames, size and sheet in any order
+  while ( ( part = strtok( NULL, ":" ) ) != NULL ) {
+    int a = 0;
+    int b = 0;
+    char separator = '\0';
+    int fields = sscanf( part, "%d%c%d", &a, &separator, &b );
+    if ( strcmp( part, "sheet" ) == 0 ) {
+      job->sheet = true;
+    } else if ( fields == 3 && separator == 'x' ) {
+      job->width = a;
+      job->height = b;
+    } else if ( fields == 3 && separator == '-' ) {
+      job->first = a;
+      job->last = b;
+    } else if ( fields == 1 ) {
+      job->first = a;
+      job->last = a;
+    } else {
+      printf( "Unknown parameter %s in %s\n", part, spec );
+      return false;
+    }
+  }
+  if ( job->first < 0 || job->last < job->first || job->width < 1 ||
+       job->height < 1 ) {
+    printf( "Invalid frames or size in %s\n", spec );
+    return false;
+  }
+  return true;
+}
+
+bool createSheet( BatchJob* job ) {
+  int frames = job->last - job->first + 1;
+  job->sheetColumns = 1;
+  while ( job->sheetColumns * job->sheetColumns < frames ) {
+    ++job->sheetColumns;
+  }
+  int rows = ( frames + job->sheetColumns - 1 ) / job->sheetColumns;
+  job->sheetSurface = SDL_CreateRGBSurfaceWithFormat(
+      0, job->sheetColumns * job->width, rows * job->height, 32,
+      SDL_PIXELFORMAT_ARGB8888 );
+  if ( job->sheetSurface == NULL ) {
+    printf( "Unable to create sprite sheet! SDL Error: %s\n",
+            SDL_GetError() );
+    return false;
+  }
+  LMemoryTrackSurface( job->sheetSurface, job->scene->mName );
+  return true;
+}
+
+void decodeTask( void* data ) {
+  SDL_Surface** media = (SDL_Surface**)data;
+  const LScene* scene = &gLScenes[media - gSceneMedia];
+  SDL_LockMutex( gLoadLock );
+  *media = scene->mDecode();
+  SDL_UnlockMutex( gLoadLock );
+  if ( *media == NULL ) {
+    printf( "Failed to decode scene %s!\n", scene->mName );
+  }
+}
+
+void renderTask( void* data ) {
+  RenderTask* task = (RenderTask*)data;
+  BatchJob* job = task->job;
+  SDL_Surface* media = gSceneMedia[job->scene - gLScenes];
+
+  // Offscreen target at output size, scene drawn scaled to fit
+  SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(
+      0, job->width, job->height, 32, SDL_PIXELFORMAT_ARGB8888 );
+  SDL_Renderer* renderer =
+      target != NULL ? SDL_CreateSoftwareRenderer( target ) : NULL;
+  if ( renderer == NULL ) {
+    printf( "Software renderer could not be created! SDL Error: %s\n",
+            SDL_GetError() );
+    SDL_AtomicAdd( &gFailures, task->last - task->first + 1 );
+    SDL_FreeSurface( target );
+    free( task );
+    return;
+  }
+  SDL_RenderSetLogicalSize( renderer, LSCENE_WIDTH, LSCENE_HEIGHT );
+
+  // Upload the scene's shared media, decoded once before any task ran
+  void* state = NULL;
+  if ( media != NULL ) {
+    SDL_LockMutex( gLoadLock );
+    state = job->scene->mLoad( renderer, media );
+    SDL_UnlockMutex( gLoadLock );
+  }
+  if ( state == NULL ) {
+    printf( "Failed to load scene %s!\n", job->scene->mName );
+    SDL_AtomicAdd( &gFailures, task->last - task->first + 1 );
+  }
+
+  for ( int frame = task->first; frame <= task->last && state != NULL;
+        ++frame ) {
+    // Clear target and draw frame
+    SDL_SetRenderDrawColor( renderer, 0xFF, 0xFF, 0xFF, 0xFF );
+    SDL_RenderClear( renderer );
+    job->scene->mRender( state, renderer, frame );
+    SDL_RenderFlush( renderer );
+    SDL_AtomicIncRef( &gRenderedFrames );
+
+    // Tasks fill separate cells, so the sheet needs no lock
+    if ( job->sheet ) {
+      int cell = frame - job->first;
+      SDL_Rect cellRect = { cell % job->sheetColumns * job->width,
+                            cell / job->sheetColumns * job->height,
+                            job->width, job->height };
+      SDL_SetSurfaceBlendMode( target, SDL_BLENDMODE_NONE );
+      SDL_BlitSurface( target, NULL, job->sheetSurface, &cellRect );
+      continue;
+    }
+
+    // Keep the target for the next frame and hand a copy to the encoders
+    char path[MAX_PATH_SIZE];
+    snprintf( path, sizeof( path ), "%s/%s_%dx%d_%04d.png", gOutputDirectory,
+              job->scene->mName, job->width, job->height, frame );
+    SDL_Surface* copy = SDL_DuplicateSurface( target );
+    if ( copy == NULL ) {
+      printf( "Unable to copy frame %s! SDL Error: %s\n", path,
+              SDL_GetError() );
+      SDL_AtomicIncRef( &gFailures );
+      continue;
+    }
+    submitEncode( copy, path );
+  }
+
+  if ( state != NULL ) {
+    SDL_LockMutex( gLoadLock );
+    job->scene->mFree( state );
+    SDL_UnlockMutex( gLoadLock );
+  }
+  SDL_DestroyRenderer( renderer );
+  SDL_FreeSurface( target );
+  free( task );
+}
+
+void encodeTask( void* data ) {
+  EncodeTask* task = (EncodeTask*)data;
+  if ( IMG_SavePNG( task->surface, task->path ) != 0 ) {
+    printf( "Unable to save %s! SDL_image Error: %s\n", task->path,
+            IMG_GetError() );
+    SDL_AtomicIncRef( &gFailures );
+  } else {
+    SDL_AtomicIncRef( &gWrittenFiles );
+  }
+  LMemoryUntrack( task->surface );
+  SDL_FreeSurface( task->surface );
+  SDL_AtomicAdd( &gPendingFrames, -1 );
+  free( task );
+}
+
+void submitEncode( SDL_Surface* surface, const char* path ) {
+  EncodeTask* task = (EncodeTask*)malloc( sizeof( EncodeTask ) );
+  if ( task == NULL ) {
+    printf( "Unable to allocate encode task!\n" );
+    SDL_AtomicIncRef( &gFailures );
+    SDL_FreeSurface( surface );
+    return;
+  }
+  task->surface = surface;
+  snprintf( task->path, sizeof( task->path ), "%s", path );
+  LMemoryTrackSurface( surface, "pending frame" );
+
+  // Encoding is slower than software rendering, so without a bound rendered
+  // frames would pile up in memory
+  if ( SDL_AtomicAdd( &gPendingFrames, 1 ) >= MAX_PENDING_FRAMES ) {
+    encodeTask( task );
+  } else {
+    LJobsSubmit( &gJobs, encodeTask, task, &gEncoded, NULL );
+  }
+}
+
+void encodeSheet( void* data ) {
+  BatchJob* job = (BatchJob*)data;
+  char path[MAX_PATH_SIZE];
+  snprintf( path, sizeof( path ), "%s/%s_%dx%d_sheet.png", gOutputDirectory,
+            job->scene->mName, job->width, job->height );
+  LMemoryUntrack( job->sheetSurface );
+  submitEncode( job->sheetSurface, path );
+  job->sheetSurface = NULL;
+}
+
+int main( int argc, char* argv[] ) {
+  // Job specs, workers and output directory from the command line
+  static BatchJob jobs[MAX_BATCH_JOBS];
+  int jobCount = 0;
+  int workerCount = SDL_GetCPUCount();
+  bool success = true;
+  for ( int i = 1; i < argc && success; ++i ) {
+    if ( strcmp( argv[i], "--threads" ) == 0 && i + 1 < argc ) {
+      workerCount = atoi( argv[++i] );
+    } else if ( strcmp( argv[i], "--out" ) == 0 && i + 1 < argc ) {
+      gOutputDirectory = argv[++i];
+    } else if ( jobCount == MAX_BATCH_JOBS ) {
+      printf( "Too many jobs, at most %d\n", MAX_BATCH_JOBS );
+      success = false;
+    } else {
+      success = parseJob( argv[i], &jobs[jobCount++] );
+    }
+  }
+
+  // Without jobs on the command line read one spec per line
+  char line[MAX_PATH_SIZE];
+  bool readSpecs = jobCount == 0;
+  while ( success && readSpecs && fgets( line, sizeof( line ), stdin ) ) {
+    line[strcspn( line, "\r\n" )] = '\0';
+    if ( line[0] == '\0' || line[0] == '#' ) {
+      continue;
+    }
+    if ( jobCount == MAX_BATCH_JOBS ) {
+      printf( "Too many jobs, at most %d\n", MAX_BATCH_JOBS );
+      success = false;
+    } else {
+      success = parseJob( line, &jobs[jobCount++] );
+    }
+  }
+  if ( !success ) {
+    printf( "Usage: my_batch_render [--threads n] [--out directory] "
+            "scene[:first-last][:WIDTHxHEIGHT][:sheet]...\n" );
+    return 1;
+  }
+
+  if ( !init( workerCount ) ) {
+    printf( "Failed to initialize!\n" );
+    success = false;
+  } else {
+#ifndef _WIN32
+    mkdir( gOutputDirectory, 0755 );
+#endif
+
+    // Queue every job's render tasks, then its sheet once they're done
+    Uint64 start = SDL_GetPerformanceCounter();
+    for ( int i = 0; i < jobCount; ++i ) {
+      BatchJob* job = &jobs[i];
+      if ( job->sheet && !createSheet( job ) ) {
+        SDL_AtomicIncRef( &gFailures );
+        continue;
+      }
+
+      // Decode each scene once, before the first task that renders it
+      int sceneIndex = (int)( job->scene - gLScenes );
+      if ( !gSceneQueued[sceneIndex] ) {
+        LJobsSubmit( &gJobs, decodeTask, &gSceneMedia[sceneIndex],
+                     &gSceneDecoded[sceneIndex], NULL );
+        gSceneQueued[sceneIndex] = true;
+      }
+      for ( int first = job->first; first <= job->last;
+            first += FRAMES_PER_TASK ) {
+        RenderTask* task = (RenderTask*)malloc( sizeof( RenderTask ) );
+        if ( task == NULL ) {
+          printf( "Unable to allocate render task!\n" );
+          SDL_AtomicIncRef( &gFailures );
+          break;
+        }
+        task->job = job;
+        task->first = first;
+        task->last = SDL_min( first + FRAMES_PER_TASK - 1, job->last );
+        LJobsSubmit( &gJobs, renderTask, task, &job->rendered,
+                     &gSceneDecoded[sceneIndex] );
+      }
+      if ( job->sheet ) {
+        LJobsSubmit( &gJobs, encodeSheet, job, &gEncoded, &job->rendered );
+      }
+    }
+
+    // Every encode is queued once rendering is done
+    for ( int i = 0; i < jobCount; ++i ) {
+      LJobsWait( &gJobs, &jobs[i].rendered );
+    }
+    LJobsWait( &gJobs, &gEncoded );
+    LJobsEndFrame( &gJobs );
+    Uint64 end = SDL_GetPerformanceCounter();
+
+    double seconds =
+        (double)( end - start ) / (double)SDL_GetPerformanceFrequency();
+    int frames = SDL_AtomicGet( &gRenderedFrames );
+    printf( "%d frames, %d files in %.2f s on %d workers, %.1f frames/s, "
+            "peak %.1f MB in surfaces\n",
+            frames, SDL_AtomicGet( &gWrittenFiles ), seconds,
+            gJobs.mWorkerCount, seconds > 0.0 ? (double)frames / seconds : 0.0,
+            (double)LMemoryPeak( LMEMORY_SURFACE ) / ( 1024.0 * 1024.0 ) );
+    for ( int i = 0; i < gJobs.mWorkerCount; ++i ) {
+      printf( "Worker %d ran %d tasks\n", i,
+              SDL_AtomicGet( &gJobs.mExecuted[i] ) );
+    }
+    if ( SDL_AtomicGet( &gFailures ) > 0 ) {
+      printf( "%d frames or files failed\n", SDL_AtomicGet( &gFailures ) );
+      success = false;
+    }
+  }
+
+  // Stop workers and close SDL
+  close();
+
+  return success ? 0 : 1;
+}
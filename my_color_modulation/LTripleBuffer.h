@@ -0,0 +1,89 @@
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Set in the shared index when the slot holds a snapshot not yet read
+#define LTRIPLE_BUFFER_FRESH 4
+
+// Hands complete snapshots from one producer thread to one consumer thread
+// The producer fills its own slot and swaps it with the shared one, the
+// consumer swaps the shared slot for its own when it's newer. Neither side
+// ever waits for the other, and the consumer always sees the newest snapshot
+// that was completely written
+typedef struct LTripleBuffer LTripleBuffer;
+
+// creates LTripleBuffer holding snapshots of size bytes, all zeroed
+LTripleBuffer LTripleBufferNew( size_t size );
+
+// Deallocates LTripleBuffer
+void LTripleBufferFree( LTripleBuffer* lTripleBuffer );
+
+// Returns slot for producer to fill with the next snapshot
+void* LTripleBufferWriteSlot( LTripleBuffer* lTripleBuffer );
+
+// Publishes filled slot, producer gets a new slot to write
+void LTripleBufferPublish( LTripleBuffer* lTripleBuffer );
+
+// Returns newest published snapshot, valid until the next call
+const void* LTripleBufferRead( LTripleBuffer* lTripleBuffer );
+
+typedef struct LTripleBuffer {
+  // Three snapshots back to back
+  Uint8* mSlots;
+  size_t mSize;
+
+  // Slot owned by producer
+  int mWrite;
+
+  // Slot owned by consumer
+  int mRead;
+
+  // Slot between them, with LTRIPLE_BUFFER_FRESH when it was published after
+  // the consumer last took it
+  SDL_atomic_t mShared;
+} LTripleBuffer;
+
+LTripleBuffer LTripleBufferNew( size_t size ) {
+  LTripleBuffer lTripleBuffer;
+  memset( &lTripleBuffer, 0, sizeof( lTripleBuffer ) );
+  lTripleBuffer.mSlots = (Uint8*)calloc( 3, size );
+  if ( lTripleBuffer.mSlots == NULL ) {
+    printf( "Unable to allocate triple buffer!\n" );
+    return lTripleBuffer;
+  }
+  lTripleBuffer.mSize = size;
+  lTripleBuffer.mWrite = 0;
+  lTripleBuffer.mRead = 1;
+  SDL_AtomicSet( &lTripleBuffer.mShared, 2 );
+  return lTripleBuffer;
+}
+
+void LTripleBufferFree( LTripleBuffer* lTripleBuffer ) {
+  free( lTripleBuffer->mSlots );
+  memset( lTripleBuffer, 0, sizeof( LTripleBuffer ) );
+}
+
+void* LTripleBufferWriteSlot( LTripleBuffer* lTripleBuffer ) {
+  return lTripleBuffer->mSlots +
+         (size_t)lTripleBuffer->mWrite * lTripleBuffer->mSize;
+}
+
+void LTripleBufferPublish( LTripleBuffer* lTripleBuffer ) {
+  // Atomic swap is a full barrier, so the snapshot is visible before its index
+  int previous = SDL_AtomicSet( &lTripleBuffer->mShared,
+                                lTripleBuffer->mWrite | LTRIPLE_BUFFER_FRESH );
+  lTripleBuffer->mWrite = previous & ~LTRIPLE_BUFFER_FRESH;
+}
+
+const void* LTripleBufferRead( LTripleBuffer* lTripleBuffer ) {
+  // Take shared slot only if something newer was published
+  if ( SDL_AtomicGet( &lTripleBuffer->mShared ) & LTRIPLE_BUFFER_FRESH ) {
+    int previous =
+        SDL_AtomicSet( &lTripleBuffer->mShared, lTripleBuffer->mRead );
+    lTripleBuffer->mRead = previous & ~LTRIPLE_BUFFER_FRESH;
+  }
+  return lTripleBuffer->mSlots +
+         (size_t)lTripleBuffer->mRead * lTripleBuffer->mSize;
+}
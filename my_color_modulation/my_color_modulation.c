@@ -3,12 +3,17 @@ and may not be redistributed without written permission.*/
 
 // Using SDL, SDL_image, standard math, and strings
 #include "LTexture.h"
-#include <time.h>
+#include "LTripleBuffer.h"
 
 // Screen dimension constants
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+// Color wheel steps per second of real time, a full turn is 6 * 0xFF steps
+// The wheel used to advance one step per vsynced frame, this keeps that speed
+// of about 25 seconds per turn without depending on the frame rate
+const int COLOR_TICKS_PER_SECOND = 60;
+
 // Starts up SDL and creates window
 bool init( void );
 
@@ -27,6 +32,25 @@ SDL_Renderer* gRenderer = NULL;
 // Scene texture
 LTexture gModulatedTexture;
 
+// Simulation state published to the render thread
+typedef struct ColorState {
+  Uint8 r;
+  Uint8 g;
+  Uint8 b;
+} ColorState;
+
+// Snapshots from simulation thread to render thread
+LTripleBuffer gColorStates;
+
+// Tells simulation thread to stop
+SDL_atomic_t gSimulationQuit;
+
+// Maps position along the color wheel to modulation components
+void computeColor( int ticks, ColorState* state );
+
+// Advances color wheel and publishes snapshots until told to quit
+int simulate( void* data );
+
 bool init() {
   // Initialization flag
   bool success = true;
@@ -88,6 +112,61 @@ bool loadMedia() {
   return success;
 }
 
+void computeColor( int ticks, ColorState* state ) {
+  if ( ticks < 0xFF ) {
+    state->r = 0xFF;
+    state->g = (Uint8)( ticks % 0xFF );
+    state->b = 0;
+  } else if ( ticks < 2 * 0xFF ) {
+    state->r = (Uint8)( 0xFF - ticks % 0xFF );
+    state->g = 0xFF;
+    state->b = 0;
+  } else if ( ticks < 3 * 0xFF ) {
+    state->r = 0;
+    state->g = 0xFF;
+    state->b = (Uint8)( ticks % 0xFF );
+  } else if ( ticks < 4 * 0xFF ) {
+    state->r = 0;
+    state->g = (Uint8)( 0xFF - ticks % 0xFF );
+    state->b = 0xFF;
+  } else if ( ticks < 5 * 0xFF ) {
+    state->r = (Uint8)( ticks % 0xFF );
+    state->g = 0;
+    state->b = 0xFF;
+  } else {
+    state->r = 0xFF;
+    state->g = 0;
+    state->b = (Uint8)( 0xFF - ticks % 0xFF );
+  }
+}
+
+int simulate( void* data ) {
+  (void)data;
+
+  int ticks = 0;
+  Uint64 frequency = SDL_GetPerformanceFrequency();
+  Uint64 timer = SDL_GetPerformanceCounter();
+
+  while ( !SDL_AtomicGet( &gSimulationQuit ) ) {
+    // Advance by every tick that elapsed, however long the last step took
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 elapsed =
+        ( now - timer ) * (Uint64)COLOR_TICKS_PER_SECOND / frequency;
+    if ( elapsed > 0 ) {
+      ticks = (int)( ( (Uint64)ticks + elapsed ) % ( 6 * 0xFF ) );
+      timer += elapsed * frequency / (Uint64)COLOR_TICKS_PER_SECOND;
+
+      computeColor( ticks,
+                    (ColorState*)LTripleBufferWriteSlot( &gColorStates ) );
+      LTripleBufferPublish( &gColorStates );
+    }
+
+    SDL_Delay( 1 );
+  }
+
+  return 0;
+}
+
 void close() {
   // Free loaded images
   freeLTexture( &gModulatedTexture );
@@ -118,17 +197,26 @@ int main() {
       // Event handler
       SDL_Event e;
 
-      // Modulation components
-      Uint8 r = 255;
-      Uint8 g = 255;
-      Uint8 b = 255;
-
-      // precompute color scheme
+      // Publish a first snapshot so the render thread never sees garbage
+      gColorStates = LTripleBufferNew( sizeof( ColorState ) );
+      if ( gColorStates.mSlots == NULL ) {
+        quit = true;
+      } else {
+        computeColor( 0, (ColorState*)LTripleBufferWriteSlot( &gColorStates ) );
+        LTripleBufferPublish( &gColorStates );
+      }
 
-      int ticks = 0;
-      int tickBy = 1;
-      int ticksPerSecond = 10000;
-      clock_t timer = clock();
+      // Run simulation independently of presenting
+      SDL_Thread* simulation = NULL;
+      if ( !quit ) {
+        SDL_AtomicSet( &gSimulationQuit, 0 );
+        simulation = SDL_CreateThread( simulate, "Simulation", NULL );
+        if ( simulation == NULL ) {
+          printf( "Unable to start simulation! SDL Error: %s\n",
+                  SDL_GetError() );
+          quit = true;
+        }
+      }
 
       // While application is running
       while ( !quit ) {
@@ -140,47 +228,16 @@ int main() {
           }
         }
 
-        double deltaTime = (double)( clock() - timer ) / CLOCKS_PER_SEC;
-        if ( deltaTime > 1 / (double)ticksPerSecond ) {
-          ticks += tickBy;
-          ticks %= ( 6 * 0xFF );
-          timer = clock();
-          // printf( "Delta time: %f Target: %f\n", deltaTime,
-          //         1 / (double)ticksPerSecond );
-        }
-
-        if ( ticks < 0xFF ) {
-          r = 0xFF;
-          g = ticks % 0xFF;
-          b = 0;
-        } else if ( ticks < 2 * 0xFF ) {
-          r = 0xFF - ticks % 0xFF;
-          g = 0xFF;
-          b = 0;
-        } else if ( ticks < 3 * 0xFF ) {
-          r = 0;
-          g = 0xFF;
-          b = ticks % 0xFF;
-        } else if ( ticks < 4 * 0xFF ) {
-          r = 0;
-          g = 0xFF - ticks % 0xFF;
-          b = 0xFF;
-        } else if ( ticks < 5 * 0xFF ) {
-          r = ticks % 0xFF;
-          g = 0;
-          b = 0xFF;
-        } else {
-          r = 0xFF;
-          g = 0;
-          b = 0xFF - ticks % 0xFF;
-        }
+        // Draw latest complete simulation state
+        const ColorState* state =
+            (const ColorState*)LTripleBufferRead( &gColorStates );
 
         // Clear screen
         SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
         SDL_RenderClear( gRenderer );
 
         // Modulate and render texture
-        setColorLTexture( &gModulatedTexture, r, g, b );
+        setColorLTexture( &gModulatedTexture, state->r, state->g, state->b );
         renderLTexture( &gModulatedTexture,
                         ( SCREEN_WIDTH - gModulatedTexture.mWidth * 4 ) / 2,
                         ( SCREEN_HEIGHT - gModulatedTexture.mHeight * 4 ) / 2,
@@ -189,6 +246,13 @@ int main() {
         // Update screen
         SDL_RenderPresent( gRenderer );
       }
+
+      // Stop simulation before its buffer goes away
+      if ( simulation != NULL ) {
+        SDL_AtomicSet( &gSimulationQuit, 1 );
+        SDL_WaitThread( simulation, NULL );
+      }
+      LTripleBufferFree( &gColorStates );
     }
   }
 
@@ -0,0 +1,359 @@
+#ifndef LSCENES_H
+#define LSCENES_H
+
+#include "LTexture.h"
+#include "LSpriteBatch.h"
+#include <stdlib.h>
+
+// Size every scene is laid out for
+#define LSCENE_WIDTH 640
+#define LSCENE_HEIGHT 480
+
+// Tutorial scene drawn purely from a frame number
+// Media is decoded once by mDecode into a surface that mLoad only reads, so
+// several renderers can load the same scene from one decode. State is
+// returned by mLoad and owned by the caller. Nothing reads the clock, which
+// makes frame n look the same on every run
+typedef struct LScene {
+  const char* mName;
+
+  // Scene whose goldens this one must match, NULL if it has its own
+  const char* mGolden;
+
+  // Decodes scene's media, NULL on failure
+  SDL_Surface* ( *mDecode )( void );
+
+  // Uploads decoded media for renderer, NULL on failure
+  void* ( *mLoad )( SDL_Renderer* gRenderer, SDL_Surface* media );
+
+  // Draws frame over a cleared target
+  void ( *mRender )( void* state, SDL_Renderer* gRenderer, int frame );
+
+  // Frees what mLoad made
+  void ( *mFree )( void* state );
+} LScene;
+
+// Frees media made by a scene's mDecode
+static void LSceneFreeMedia( SDL_Surface* media ) {
+  LMemoryUntrack( media );
+  SDL_FreeSurface( media );
+}
+
+// Sprite sheet corners from clip rendering
+typedef struct LClipScene {
+  LTexture mSheet;
+} LClipScene;
+
+static SDL_Surface* LClipSceneDecode() {
+  return LTextureDecodeFile( "11_clip_rendering_and_sprite_sheets/dots.png" );
+}
+
+static void* LClipSceneLoad( SDL_Renderer* gRenderer, SDL_Surface* media ) {
+  LClipScene* scene = (LClipScene*)calloc( 1, sizeof( LClipScene ) );
+  if ( scene == NULL || !LTextureLoadFromSurface( &scene->mSheet, gRenderer,
+                                                  media, "clip_rendering" ) ) {
+    free( scene );
+    return NULL;
+  }
+  return scene;
+}
+
+static void LClipSceneRender( void* state, SDL_Renderer* gRenderer,
+                              int frame ) {
+  LClipScene* scene = (LClipScene*)state;
+
+  // Each corner shows a different dot, rotating one corner per frame
+  for ( int corner = 0; corner < 4; ++corner ) {
+    int dot = ( corner + frame ) % 4;
+    SDL_Rect clip = { dot % 2 * 100, dot / 2 * 100, 100, 100 };
+    int x = corner % 2 == 0 ? 0 : LSCENE_WIDTH - clip.w;
+    int y = corner / 2 == 0 ? 0 : LSCENE_HEIGHT - clip.h;
+    LTextureRender( &scene->mSheet, gRenderer, x, y, &clip, 0, NULL,
+                    SDL_FLIP_NONE );
+  }
+}
+
+static void LClipSceneFree( void* state ) {
+  LClipScene* scene = (LClipScene*)state;
+  LTextureFree( &scene->mSheet );
+  free( scene );
+}
+
+// Color and alpha modulation
+typedef struct LModulationScene {
+  LTexture mColors;
+} LModulationScene;
+
+static SDL_Surface* LModulationSceneDecode() {
+  return LTextureDecodeFile( "12_color_modulation/colors.png" );
+}
+
+static void* LModulationSceneLoad( SDL_Renderer* gRenderer,
+                                   SDL_Surface* media ) {
+  LModulationScene* scene =
+      (LModulationScene*)calloc( 1, sizeof( LModulationScene ) );
+  if ( scene == NULL ||
+       !LTextureLoadFromSurface( &scene->mColors, gRenderer, media,
+                                 "color_modulation" ) ) {
+    free( scene );
+    return NULL;
+  }
+  LTextureSetBlendMode( &scene->mColors, SDL_BLENDMODE_BLEND );
+  return scene;
+}
+
+static void LModulationSceneRender( void* state, SDL_Renderer* gRenderer,
+                                    int frame ) {
+  LModulationScene* scene = (LModulationScene*)state;
+
+  // Step channels like the tutorial's keys, fading out over the sequence
+  LTextureSetColor( &scene->mColors, (Uint8)( 0xFF - frame * 32 ),
+                    (Uint8)( 0xFF - frame * 16 ), (Uint8)( frame * 48 ) );
+  LTextureSetAlpha( &scene->mColors, (Uint8)( 0xFF - frame * 8 ) );
+  LTextureRender( &scene->mColors, gRenderer, 0, 0, NULL, 0, NULL,
+                  SDL_FLIP_NONE );
+}
+
+static void LModulationSceneFree( void* state ) {
+  LModulationScene* scene = (LModulationScene*)state;
+  LTextureFree( &scene->mColors );
+  free( scene );
+}
+
+// Swatch grid from color modulation, drawn one copy at a time or batched
+// Both draw the same pixels, so the batched scene is checked against the
+// goldens of the one drawn with SDL_SetTextureColorMod
+#define LSWATCH_COLUMNS 10
+#define LSWATCH_ROWS 10
+
+static const SDL_Color LSWATCH_TINTS[LSWATCH_COLUMNS] = {
+    { 0xFF, 0x00, 0x00, 0xFF }, { 0xFF, 0x80, 0x00, 0xFF },
+    { 0xFF, 0xFF, 0x00, 0xFF }, { 0x80, 0xFF, 0x00, 0xFF },
+    { 0x00, 0xFF, 0x00, 0xFF }, { 0x00, 0xFF, 0xFF, 0xFF },
+    { 0x00, 0x00, 0xFF, 0xFF }, { 0xFF, 0x00, 0xFF, 0xFF },
+    { 0xFF, 0xFF, 0xFF, 0x80 }, { 0x40, 0x40, 0x40, 0xFF } };
+
+typedef struct LSwatchScene {
+  LTexture mColors;
+  LSpriteBatch mBatch;
+} LSwatchScene;
+
+static void* LSwatchSceneLoad( SDL_Renderer* gRenderer, SDL_Surface* media ) {
+  LSwatchScene* scene = (LSwatchScene*)calloc( 1, sizeof( LSwatchScene ) );
+  if ( scene == NULL ) {
+    return NULL;
+  }
+  scene->mBatch = LSpriteBatchNew();
+  if ( !LTextureLoadFromSurface( &scene->mColors, gRenderer, media,
+                                 "swatches" ) ||
+       !LSpriteBatchCreate( &scene->mBatch,
+                            LSWATCH_COLUMNS * LSWATCH_ROWS ) ) {
+    LTextureFree( &scene->mColors );
+    free( scene );
+    return NULL;
+  }
+  LTextureSetBlendMode( &scene->mColors, SDL_BLENDMODE_BLEND );
+  return scene;
+}
+
+// Returns where swatch goes and its tint, shifting tints along each frame
+static SDL_Color LSwatchScenePlace( int swatch, int frame, SDL_Rect* rect ) {
+  int column = swatch % LSWATCH_COLUMNS;
+  int row = swatch / LSWATCH_COLUMNS;
+  rect->w = LSCENE_WIDTH / LSWATCH_COLUMNS;
+  rect->h = LSCENE_HEIGHT / LSWATCH_ROWS;
+  rect->x = column * rect->w;
+  rect->y = row * rect->h;
+  return LSWATCH_TINTS[( column + row + frame ) % LSWATCH_COLUMNS];
+}
+
+static void LSwatchSceneRender( void* state, SDL_Renderer* gRenderer,
+                                int frame ) {
+  LSwatchScene* scene = (LSwatchScene*)state;
+
+  // One copy per swatch, tinted through the texture's modulation
+  for ( int i = 0; i < LSWATCH_COLUMNS * LSWATCH_ROWS; ++i ) {
+    SDL_Rect swatch;
+    SDL_Color tint = LSwatchScenePlace( i, frame, &swatch );
+    LTextureSetColor( &scene->mColors, tint.r, tint.g, tint.b );
+    LTextureSetAlpha( &scene->mColors, tint.a );
+    SDL_RenderCopy( gRenderer, scene->mColors.mTexture, NULL, &swatch );
+  }
+  LTextureSetColor( &scene->mColors, 0xFF, 0xFF, 0xFF );
+  LTextureSetAlpha( &scene->mColors, 0xFF );
+}
+
+static void LSwatchSceneRenderBatched( void* state, SDL_Renderer* gRenderer,
+                                       int frame ) {
+  LSwatchScene* scene = (LSwatchScene*)state;
+
+  // Every swatch in one geometry call, tinted through the vertices
+  LSpriteBatchBegin( &scene->mBatch, &scene->mColors, gRenderer );
+  for ( int i = 0; i < LSWATCH_COLUMNS * LSWATCH_ROWS; ++i ) {
+    SDL_Rect swatch;
+    SDL_Color tint = LSwatchScenePlace( i, frame, &swatch );
+    LSpriteBatchDraw( &scene->mBatch, NULL, &swatch, tint );
+  }
+  LSpriteBatchEnd( &scene->mBatch );
+}
+
+static void LSwatchSceneFree( void* state ) {
+  LSwatchScene* scene = (LSwatchScene*)state;
+  LSpriteBatchFree( &scene->mBatch );
+  LTextureFree( &scene->mColors );
+  free( scene );
+}
+
+// Walk cycle from animated sprites
+typedef struct LSpriteScene {
+  LTexture mSheet;
+} LSpriteScene;
+
+static SDL_Surface* LSpriteSceneDecode() {
+  return LTextureDecodeFile( "14_animated_sprites_and_vsync/foo.png" );
+}
+
+static void* LSpriteSceneLoad( SDL_Renderer* gRenderer, SDL_Surface* media ) {
+  LSpriteScene* scene = (LSpriteScene*)calloc( 1, sizeof( LSpriteScene ) );
+  if ( scene == NULL ||
+       !LTextureLoadFromSurface( &scene->mSheet, gRenderer, media,
+                                 "animated_sprites" ) ) {
+    free( scene );
+    return NULL;
+  }
+  return scene;
+}
+
+static void LSpriteSceneRender( void* state, SDL_Renderer* gRenderer,
+                                int frame ) {
+  LSpriteScene* scene = (LSpriteScene*)state;
+
+  // Four frame cycle, each shown for four frames
+  SDL_Rect clip = { frame / 4 % 4 * 64, 0, 64, 205 };
+  LTextureRender( &scene->mSheet, gRenderer, ( LSCENE_WIDTH - clip.w ) / 2,
+                  ( LSCENE_HEIGHT - clip.h ) / 2, &clip, 0, NULL,
+                  SDL_FLIP_NONE );
+}
+
+static void LSpriteSceneFree( void* state ) {
+  LSpriteScene* scene = (LSpriteScene*)state;
+  LTextureFree( &scene->mSheet );
+  free( scene );
+}
+
+// Arrow from rotation and flipping
+typedef struct LArrowScene {
+  LTexture mArrow;
+} LArrowScene;
+
+static SDL_Surface* LArrowSceneDecode() {
+  return LTextureDecodeFile( "15_rotation_and_flipping/arrow.png" );
+}
+
+static void* LArrowSceneLoad( SDL_Renderer* gRenderer, SDL_Surface* media ) {
+  LArrowScene* scene = (LArrowScene*)calloc( 1, sizeof( LArrowScene ) );
+  if ( scene == NULL ||
+       !LTextureLoadFromSurface( &scene->mArrow, gRenderer, media,
+                                 "rotation_and_flipping" ) ) {
+    free( scene );
+    return NULL;
+  }
+  return scene;
+}
+
+static void LArrowSceneRender( void* state, SDL_Renderer* gRenderer,
+                               int frame ) {
+  LArrowScene* scene = (LArrowScene*)state;
+
+  // Rotate by uneven steps so resampling is exercised, flip every 4 frames
+  const SDL_RendererFlip flips[3] = { SDL_FLIP_NONE, SDL_FLIP_HORIZONTAL,
+                                      SDL_FLIP_VERTICAL };
+  LTextureRender( &scene->mArrow, gRenderer,
+                  ( LSCENE_WIDTH - scene->mArrow.mWidth ) / 2,
+                  ( LSCENE_HEIGHT - scene->mArrow.mHeight ) / 2, NULL,
+                  frame * 37.5, NULL, flips[frame / 4 % 3] );
+}
+
+static void LArrowSceneFree( void* state ) {
+  LArrowScene* scene = (LArrowScene*)state;
+  LTextureFree( &scene->mArrow );
+  free( scene );
+}
+
+// Rendered text from true type fonts
+typedef struct LTextScene {
+  LTexture mText;
+} LTextScene;
+
+static SDL_Surface* LTextSceneDecode() {
+  // Font is only needed to rasterize the text once
+  TTF_Font* font = TTF_OpenFont( "16_true_type_fonts/lazy.ttf", 28 );
+  SDL_Color textColor = { 0, 0, 0, 0xFF };
+  SDL_Surface* text =
+      font != NULL ? TTF_RenderText_Solid(
+                         font, "The quick brown fox jumps over the lazy dog",
+                         textColor )
+                   : NULL;
+  if ( text == NULL ) {
+    printf( "Unable to render text scene! SDL_ttf Error: %s\n",
+            TTF_GetError() );
+  }
+  if ( font != NULL ) {
+    TTF_CloseFont( font );
+  }
+  LMemoryTrackSurface( text, "true_type_fonts" );
+  return text;
+}
+
+static void* LTextSceneLoad( SDL_Renderer* gRenderer, SDL_Surface* media ) {
+  LTextScene* scene = (LTextScene*)calloc( 1, sizeof( LTextScene ) );
+  if ( scene == NULL || !LTextureLoadFromSurface( &scene->mText, gRenderer,
+                                                  media, "true_type_fonts" ) ) {
+    free( scene );
+    return NULL;
+  }
+  return scene;
+}
+
+static void LTextSceneRender( void* state, SDL_Renderer* gRenderer,
+                              int frame ) {
+  LTextScene* scene = (LTextScene*)state;
+
+  // Scroll text down the screen, clipped and whole
+  int y = frame % 16 * ( LSCENE_HEIGHT - scene->mText.mHeight ) / 16;
+  LTextureRender( &scene->mText, gRenderer,
+                  ( LSCENE_WIDTH - scene->mText.mWidth ) / 2, y, NULL, 0, NULL,
+                  SDL_FLIP_NONE );
+  SDL_Rect clip = { frame % 16 * 8, 0, scene->mText.mWidth / 2,
+                    scene->mText.mHeight };
+  LTextureRender( &scene->mText, gRenderer, 0, LSCENE_HEIGHT - clip.h, &clip,
+                  0, NULL, SDL_FLIP_HORIZONTAL );
+}
+
+static void LTextSceneFree( void* state ) {
+  LTextScene* scene = (LTextScene*)state;
+  LTextureFree( &scene->mText );
+  free( scene );
+}
+
+// Every scene, text last since it needs SDL_ttf
+// The batched swatches come after the scene whose goldens they match
+#define LSCENE_COUNT 7
+static const LScene gLScenes[LSCENE_COUNT] = {
+    { "clip_rendering", NULL, LClipSceneDecode, LClipSceneLoad,
+      LClipSceneRender, LClipSceneFree },
+    { "color_modulation", NULL, LModulationSceneDecode, LModulationSceneLoad,
+      LModulationSceneRender, LModulationSceneFree },
+    { "swatches", NULL, LModulationSceneDecode, LSwatchSceneLoad,
+      LSwatchSceneRender, LSwatchSceneFree },
+    { "swatches_batched", "swatches", LModulationSceneDecode, LSwatchSceneLoad,
+      LSwatchSceneRenderBatched, LSwatchSceneFree },
+    { "animated_sprites", NULL, LSpriteSceneDecode, LSpriteSceneLoad,
+      LSpriteSceneRender, LSpriteSceneFree },
+    { "rotation_and_flipping", NULL, LArrowSceneDecode, LArrowSceneLoad,
+      LArrowSceneRender, LArrowSceneFree },
+    { "true_type_fonts", NULL, LTextSceneDecode, LTextSceneLoad,
+      LTextSceneRender, LTextSceneFree },
+};
+
+#endif
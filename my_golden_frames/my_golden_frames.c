@@ -0,0 +1,297 @@
+// Using SDL, SDL_image, SDL_ttf, standard IO and the tutorial scenes
+#include "LScenes.h"
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+// Frames rendered and compared per scene
+const int FRAME_COUNT = 16;
+
+// Frames rendered per scene for timing, cycling through the sequence
+const int TIMING_FRAMES = 240;
+
+// Channel difference still counted as equal, covers rounding differences
+// between SDL versions
+const int CHANNEL_TOLERANCE = 2;
+
+// Share of pixels allowed past the channel tolerance per frame
+const double PIXEL_TOLERANCE = 0.001;
+
+// Where golden frames are kept, relative to the repository
+const char* GOLDEN_DIRECTORY = "my_golden_frames/goldens";
+
+// Outcome of one scene
+typedef struct SceneResult {
+  // Frames identical, within tolerance, off, or without a golden
+  int exact;
+  int close;
+  int failed;
+  int missing;
+
+  // Largest share of mismatched pixels over all frames
+  double worstMismatch;
+
+  // FNV-1a over every frame's pixels
+  Uint64 hash;
+
+  // Load time and average time to render a frame
+  double loadMs;
+  double frameMs;
+} SceneResult;
+
+// Starts up SDL and creates the offscreen software renderer
+bool init( void );
+
+// Frees renderer and shuts down SDL
+void close( void );
+
+// Clears target and draws scene frame, waiting for the renderer to finish
+void renderFrame( const LScene* scene, void* state, int frame );
+
+// Continues FNV-1a hash over the target's pixels
+Uint64 hashFrame( Uint64 hash );
+
+// Returns number of pixels past tolerance against golden at path, -1 if the
+// golden can't be read
+int compareGolden( const char* path );
+
+// Renders, checks and times scene, writing goldens instead when update is set
+// and the scene has its own. Frames without a golden fail the scene like
+// frames that differ
+bool runScene( const LScene* scene, bool update, SceneResult* result );
+
+// Offscreen render target
+SDL_Surface* gTarget = NULL;
+
+// Software renderer drawing into the target
+SDL_Renderer* gRenderer = NULL;
+
+bool init() {
+  // Initialize SDL
+  if ( SDL_Init( 0 ) < 0 ) {
+    printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  // Initialize PNG loading and saving
+  int imgFlags = IMG_INIT_PNG;
+  if ( !( IMG_Init( imgFlags ) & imgFlags ) ) {
+    printf( "SDL_image could not initialize! SDL_image Error: %s\n",
+            IMG_GetError() );
+    return false;
+  }
+
+  // Initialize SDL_ttf
+  if ( TTF_Init() == -1 ) {
+    printf( "SDL_ttf could not initialize! SDL_ttf Error: %s\n",
+            TTF_GetError() );
+    return false;
+  }
+
+  // Render into memory with the software renderer so output doesn't depend on
+  // the GPU or driver, only on the SDL version
+  gTarget = SDL_CreateRGBSurfaceWithFormat( 0, LSCENE_WIDTH, LSCENE_HEIGHT, 32,
+                                            SDL_PIXELFORMAT_ARGB8888 );
+  if ( gTarget == NULL ) {
+    printf( "Unable to create render target! SDL Error: %s\n",
+            SDL_GetError() );
+    return false;
+  }
+  gRenderer = SDL_CreateSoftwareRenderer( gTarget );
+  if ( gRenderer == NULL ) {
+    printf( "Software renderer could not be created! SDL Error: %s\n",
+            SDL_GetError() );
+    return false;
+  }
+  return true;
+}
+
+void close() {
+  LTextureFreeStaging();
+
+  // Destroy renderer and target
+  SDL_DestroyRenderer( gRenderer );
+  SDL_FreeSurface( gTarget );
+  gRenderer = NULL;
+  gTarget = NULL;
+
+  // Quit SDL subsystems
+  TTF_Quit();
+  IMG_Quit();
+  SDL_Quit();
+}
+
+void renderFrame( const LScene* scene, void* state, int frame ) {
+  // Clear screen
+  SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+  SDL_RenderClear( gRenderer );
+
+  scene->mRender( state, gRenderer, frame );
+
+  // Run queued draws so the target holds the frame
+  SDL_RenderFlush( gRenderer );
+}
+
+Uint64 hashFrame( Uint64 hash ) {
+  // Hash visible bytes only, row padding is undefined
+  for ( int y = 0; y < gTarget->h; ++y ) {
+    const Uint8* row = (const Uint8*)gTarget->pixels + y * gTarget->pitch;
+    for ( int x = 0; x < gTarget->w * 4; ++x ) {
+      hash ^= row[x];
+      hash *= 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+int compareGolden( const char* path ) {
+  SDL_Surface* loadedSurface = IMG_Load( path );
+  if ( loadedSurface == NULL ) {
+    return -1;
+  }
+  SDL_Surface* golden =
+      SDL_ConvertSurfaceFormat( loadedSurface, SDL_PIXELFORMAT_ARGB8888, 0 );
+  SDL_FreeSurface( loadedSurface );
+  if ( golden == NULL ) {
+    printf( "Unable to convert golden %s! SDL Error: %s\n", path,
+            SDL_GetError() );
+    return -1;
+  }
+  if ( golden->w != gTarget->w || golden->h != gTarget->h ) {
+    printf( "Golden %s is %dx%d, expected %dx%d\n", path, golden->w,
+            golden->h, gTarget->w, gTarget->h );
+    SDL_FreeSurface( golden );
+    return gTarget->w * gTarget->h;
+  }
+
+  // Count pixels where any channel is off by more than the tolerance
+  int mismatched = 0;
+  for ( int y = 0; y < gTarget->h; ++y ) {
+    const Uint8* actual = (const Uint8*)gTarget->pixels + y * gTarget->pitch;
+    const Uint8* expected = (const Uint8*)golden->pixels + y * golden->pitch;
+    for ( int x = 0; x < gTarget->w; ++x ) {
+      for ( int channel = 0; channel < 4; ++channel ) {
+        if ( abs( actual[x * 4 + channel] - expected[x * 4 + channel] ) >
+             CHANNEL_TOLERANCE ) {
+          ++mismatched;
+          break;
+        }
+      }
+    }
+  }
+  SDL_FreeSurface( golden );
+  return mismatched;
+}
+
+bool runScene( const LScene* scene, bool update, SceneResult* result ) {
+  memset( result, 0, sizeof( SceneResult ) );
+  result->hash = 14695981039346656037ull;
+
+  // Load media
+  Uint64 start = SDL_GetPerformanceCounter();
+  SDL_Surface* media = scene->mDecode();
+  void* state = media != NULL ? scene->mLoad( gRenderer, media ) : NULL;
+  LSceneFreeMedia( media );
+  Uint64 end = SDL_GetPerformanceCounter();
+  if ( state == NULL ) {
+    printf( "Failed to load scene %s!\n", scene->mName );
+    return false;
+  }
+  result->loadMs = (double)( end - start ) * 1000.0 /
+                   (double)SDL_GetPerformanceFrequency();
+
+  // Check frame sequence
+  const char* golden = scene->mGolden != NULL ? scene->mGolden : scene->mName;
+  bool write = update && scene->mGolden == NULL;
+  bool success = true;
+  for ( int frame = 0; frame < FRAME_COUNT; ++frame ) {
+    renderFrame( scene, state, frame );
+    result->hash = hashFrame( result->hash );
+
+    char path[256];
+    snprintf( path, sizeof( path ), "%s/%s_%02d.png", GOLDEN_DIRECTORY,
+              golden, frame );
+    if ( write ) {
+      if ( IMG_SavePNG( gTarget, path ) != 0 ) {
+        printf( "Unable to save golden %s! SDL_image Error: %s\n", path,
+                IMG_GetError() );
+        success = false;
+      }
+      continue;
+    }
+
+    int mismatched = compareGolden( path );
+    double mismatch =
+        (double)mismatched / (double)( gTarget->w * gTarget->h );
+    if ( mismatched < 0 ) {
+      ++result->missing;
+    } else if ( mismatched == 0 ) {
+      ++result->exact;
+    } else if ( mismatch <= PIXEL_TOLERANCE ) {
+      ++result->close;
+    } else {
+      ++result->failed;
+    }
+    result->worstMismatch = SDL_max( result->worstMismatch, mismatch );
+  }
+
+  // Time the sequence on its own, without reading anything back
+  start = SDL_GetPerformanceCounter();
+  for ( int i = 0; i < TIMING_FRAMES; ++i ) {
+    renderFrame( scene, state, i % FRAME_COUNT );
+  }
+  end = SDL_GetPerformanceCounter();
+  result->frameMs = (double)( end - start ) * 1000.0 /
+                    (double)SDL_GetPerformanceFrequency() /
+                    (double)TIMING_FRAMES;
+
+  scene->mFree( state );
+  return success && result->failed == 0 && result->missing == 0;
+}
+
+int main( int argc, char* argv[] ) {
+  // Regenerate goldens after an intended change in output
+  bool update = argc > 1 && strcmp( argv[1], "--update" ) == 0;
+
+  bool success = init();
+  if ( !success ) {
+    printf( "Failed to initialize!\n" );
+  } else {
+#ifndef _WIN32
+    if ( update ) {
+      mkdir( GOLDEN_DIRECTORY, 0755 );
+    }
+#endif
+
+    printf( "%-22s %-8s %9s  %-16s %8s %9s\n", "scene", "result", "mismatch",
+            "hash", "load ms", "ms/frame" );
+    for ( int i = 0; i < LSCENE_COUNT; ++i ) {
+      SceneResult result;
+      bool passed = runScene( &gLScenes[i], update, &result );
+      const char* outcome = "error";
+      if ( update && gLScenes[i].mGolden == NULL ) {
+        outcome = passed ? "updated" : "error";
+      } else if ( result.failed > 0 ) {
+        outcome = "FAILED";
+      } else if ( result.missing > 0 ) {
+        outcome = "missing";
+      } else if ( result.close > 0 ) {
+        outcome = "close";
+      } else if ( result.exact == FRAME_COUNT ) {
+        outcome = "exact";
+      }
+      printf( "%-22s %-8s %8.4f%%  %016llx %8.2f %9.3f\n", gLScenes[i].mName,
+              outcome, result.worstMismatch * 100.0,
+              (unsigned long long)result.hash, result.loadMs, result.frameMs );
+      success = success && passed;
+    }
+    if ( !update && !success ) {
+      printf( "Run with --update to accept the current output as golden\n" );
+    }
+  }
+
+  // Free resources and close SDL
+  close();
+
+  return success ? 0 : 1;
+}
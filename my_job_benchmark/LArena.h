@@ -0,0 +1,199 @@
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Byte written over released memory when LARENA_DEBUG is defined
+#define LARENA_POISON 0xDD
+
+// Memory handed out when the arena's own block ran out
+typedef struct LArenaOverflow LArenaOverflow;
+
+// Bump allocator for data that only lives until the end of a frame
+// Allocation is one atomic add, so jobs can allocate concurrently, and
+// everything is released at once by LArenaReset. Requests that don't fit
+// fall back to the heap and are counted, so a frame that stays inside the
+// arena provably doesn't make the arena touch malloc. Every reset bumps a
+// generation that allocations can be checked against, and builds with
+// LARENA_DEBUG defined also poison released memory
+typedef struct LArena LArena;
+
+// Two arenas alternating between frames, so the render thread can read the
+// previous frame's data while the next frame is built
+typedef struct LFrameArena LFrameArena;
+
+// creates LArena with block of capacity bytes
+LArena LArenaNew( size_t capacity );
+
+// Deallocates LArena
+void LArenaFree( LArena* lArena );
+
+// Returns size bytes aligned to align, a power of two
+void* LArenaAlloc( LArena* lArena, size_t size, size_t align );
+
+// Releases every allocation
+void LArenaReset( LArena* lArena );
+
+// Returns generation current allocations belong to
+Uint32 LArenaGeneration( LArena* lArena );
+
+// Whether allocations made in generation weren't released yet
+bool LArenaIsAlive( LArena* lArena, Uint32 generation );
+
+// creates LFrameArena of two arenas with capacity bytes each
+LFrameArena LFrameArenaNew( size_t capacity );
+
+// Deallocates LFrameArena
+void LFrameArenaFree( LFrameArena* lFrameArena );
+
+// Resets and returns the arena for a new frame, the other one keeps the
+// previous frame's data
+LArena* LFrameArenaBegin( LFrameArena* lFrameArena );
+
+typedef struct LArenaOverflow {
+  LArenaOverflow* mNext;
+} LArenaOverflow;
+
+typedef struct LArena {
+  // Block allocations are bumped out of
+  Uint8* mMemory;
+  size_t mCapacity;
+  SDL_atomic_t mUsed;
+
+  // Heap allocations made when the block was full
+  SDL_SpinLock mOverflowLock;
+  LArenaOverflow* mOverflow;
+
+  // Incremented by every reset
+  SDL_atomic_t mGeneration;
+
+  // Most bytes used in one generation and heap allocations ever made
+  size_t mPeak;
+  SDL_atomic_t mHeapAllocations;
+} LArena;
+
+typedef struct LFrameArena {
+  LArena mArenas[2];
+  int mCurrent;
+} LFrameArena;
+
+LArena LArenaNew( size_t capacity ) {
+  LArena lArena;
+  memset( &lArena, 0, sizeof( lArena ) );
+
+  // Block must fit in the atomic offset
+  if ( capacity > (size_t)SDL_MAX_SINT32 / 2 ) {
+    capacity = (size_t)SDL_MAX_SINT32 / 2;
+  }
+  lArena.mMemory = (Uint8*)malloc( capacity );
+  if ( lArena.mMemory == NULL ) {
+    printf( "Unable to allocate arena!\n" );
+    return lArena;
+  }
+  lArena.mCapacity = capacity;
+  return lArena;
+}
+
+// Frees heap fallback allocations
+static void LArenaFreeOverflow( LArena* lArena ) {
+  LArenaOverflow* overflow = lArena->mOverflow;
+  while ( overflow != NULL ) {
+    LArenaOverflow* next = overflow->mNext;
+    free( overflow );
+    overflow = next;
+  }
+  lArena->mOverflow = NULL;
+}
+
+void LArenaFree( LArena* lArena ) {
+  LArenaFreeOverflow( lArena );
+  free( lArena->mMemory );
+  memset( lArena, 0, sizeof( LArena ) );
+}
+
+void* LArenaAlloc( LArena* lArena, size_t size, size_t align ) {
+  if ( align == 0 ) {
+    align = 1;
+  }
+
+  // Reserve enough to align inside the reservation, skipping the block once
+  // it's full so the offset can't wrap
+  size_t reserve = size + align - 1;
+  if ( reserve <= lArena->mCapacity &&
+       (size_t)SDL_AtomicGet( &lArena->mUsed ) + reserve <=
+           lArena->mCapacity ) {
+    size_t offset = (size_t)SDL_AtomicAdd( &lArena->mUsed, (int)reserve );
+    if ( offset + reserve <= lArena->mCapacity ) {
+      uintptr_t address = (uintptr_t)( lArena->mMemory + offset );
+      address = ( address + align - 1 ) & ~(uintptr_t)( align - 1 );
+      return (void*)address;
+    }
+  }
+
+  // Block is full, fall back to the heap until the next reset
+  LArenaOverflow* overflow =
+      (LArenaOverflow*)malloc( sizeof( LArenaOverflow ) + reserve + align );
+  if ( overflow == NULL ) {
+    printf( "Unable to allocate %lu bytes in arena!\n", (unsigned long)size );
+    return NULL;
+  }
+  SDL_AtomicIncRef( &lArena->mHeapAllocations );
+  SDL_AtomicLock( &lArena->mOverflowLock );
+  overflow->mNext = lArena->mOverflow;
+  lArena->mOverflow = overflow;
+  SDL_AtomicUnlock( &lArena->mOverflowLock );
+
+  uintptr_t address = (uintptr_t)( overflow + 1 );
+  address = ( address + align - 1 ) & ~(uintptr_t)( align - 1 );
+  return (void*)address;
+}
+
+void LArenaReset( LArena* lArena ) {
+  size_t used = (size_t)SDL_AtomicGet( &lArena->mUsed );
+  if ( used > lArena->mCapacity ) {
+    used = lArena->mCapacity;
+  }
+  if ( used > lArena->mPeak ) {
+    lArena->mPeak = used;
+  }
+
+#ifdef LARENA_DEBUG
+  // Stale reads see the pattern instead of plausible old data, costs a pass
+  // over the used memory every reset so it's opt in
+  memset( lArena->mMemory, LARENA_POISON, used );
+#endif
+
+  LArenaFreeOverflow( lArena );
+  SDL_AtomicSet( &lArena->mUsed, 0 );
+  SDL_AtomicIncRef( &lArena->mGeneration );
+}
+
+Uint32 LArenaGeneration( LArena* lArena ) {
+  return (Uint32)SDL_AtomicGet( &lArena->mGeneration );
+}
+
+bool LArenaIsAlive( LArena* lArena, Uint32 generation ) {
+  return (Uint32)SDL_AtomicGet( &lArena->mGeneration ) == generation;
+}
+
+LFrameArena LFrameArenaNew( size_t capacity ) {
+  LFrameArena lFrameArena;
+  lFrameArena.mArenas[0] = LArenaNew( capacity );
+  lFrameArena.mArenas[1] = LArenaNew( capacity );
+  lFrameArena.mCurrent = 0;
+  return lFrameArena;
+}
+
+void LFrameArenaFree( LFrameArena* lFrameArena ) {
+  LArenaFree( &lFrameArena->mArenas[0] );
+  LArenaFree( &lFrameArena->mArenas[1] );
+}
+
+LArena* LFrameArenaBegin( LFrameArena* lFrameArena ) {
+  // Arena from two frames ago isn't read by anyone anymore
+  lFrameArena->mCurrent ^= 1;
+  LArena* lArena = &lFrameArena->mArenas[lFrameArena->mCurrent];
+  LArenaReset( lArena );
+  return lArena;
+}
@@ -0,0 +1,459 @@
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Most worker threads, not counting the thread that submits
+#define LJOBS_MAX_WORKERS 63
+
+// Jobs one worker can have queued, must be a power of two
+#define LJOBS_QUEUE_SIZE 1024
+
+// Jobs that can be submitted between two calls to LJobsEndFrame
+#define LJOBS_MAX_JOBS 8192
+
+// Idle polls a waiting thread spins for before it starts yielding its core
+#define LJOBS_SPIN_LIMIT 64
+
+// Runs job
+typedef void ( *LJobFunction )( void* data );
+
+// Runs part [begin, end) of a parallel for
+typedef void ( *LJobRangeFunction )( void* data, int begin, int end );
+
+// Unit of work
+typedef struct LJob LJob;
+
+// Counts unfinished jobs and holds jobs waiting for them
+typedef struct LJobCounter LJobCounter;
+
+// Worker owned double ended queue
+typedef struct LJobQueue LJobQueue;
+
+// Work stealing job scheduler
+// Each worker pushes and pops jobs at the bottom of its own queue and steals
+// from the top of other queues when it runs dry, so related work stays on one
+// core and idle cores balance the rest. The submitting thread is worker 0 and
+// helps run jobs while it waits on a counter. Jobs submitted with an after
+// counter are held back until every job signaling that counter finished, so a
+// frame can be described as a graph of stages
+typedef struct LJobs LJobs;
+
+// creates LJobs with default values
+LJobs LJobsNew( void );
+
+// Starts workerCount - 1 threads, worker 0 is the calling thread
+bool LJobsStart( LJobs* lJobs, int workerCount );
+
+// Stops workers and deallocates LJobs
+void LJobsFree( LJobs* lJobs );
+
+// creates LJobCounter with nothing pending
+LJobCounter LJobCounterNew( void );
+
+// Queues job, signal (may be NULL) is decremented when it finishes and
+// after (may be NULL) must reach zero before it starts
+// Submit every job signaling a counter before jobs that wait on it
+void LJobsSubmit( LJobs* lJobs, LJobFunction function, void* data,
+                  LJobCounter* signal, LJobCounter* after );
+
+// Queues function over [0, count) in pieces of at most grain indices
+void LJobsParallelFor( LJobs* lJobs, LJobRangeFunction function, void* data,
+                       int count, int grain, LJobCounter* signal,
+                       LJobCounter* after );
+
+// Runs jobs until counter reaches zero
+void LJobsWait( LJobs* lJobs, LJobCounter* lJobCounter );
+
+// Recycles job storage, call once all of the frame's counters were waited on
+void LJobsEndFrame( LJobs* lJobs );
+
+typedef struct LJob {
+  // Either function or range function is set
+  LJobFunction mFunction;
+  LJobRangeFunction mRangeFunction;
+  void* mData;
+  int mBegin;
+  int mEnd;
+
+  // Counter to decrement when done
+  LJobCounter* mSignal;
+
+  // Next job waiting on the same counter
+  LJob* mNext;
+} LJob;
+
+typedef struct LJobCounter {
+  // Submitted jobs not yet finished
+  SDL_atomic_t mPending;
+
+  // Jobs held back until pending reaches zero, the lock is held while
+  // pending goes to zero so a waiter can tell the last job let go of it
+  SDL_SpinLock mLock;
+  LJob* mWaiting;
+} LJobCounter;
+
+typedef struct LJobQueue {
+  LJob* mJobs[LJOBS_QUEUE_SIZE];
+
+  // Thieves take from top, owner works at bottom
+  int mTop;
+  int mBottom;
+  SDL_SpinLock mLock;
+} LJobQueue;
+
+typedef struct LJobs {
+  // One queue per worker, index 0 belongs to the submitting thread
+  LJobQueue* mQueues;
+  int mWorkerCount;
+
+  // Worker threads and their shutdown flag
+  SDL_Thread* mThreads[LJOBS_MAX_WORKERS];
+  SDL_atomic_t mQuit;
+
+  // Wakes idle workers
+  SDL_sem* mWake;
+
+  // Worker index + 1 of the current thread
+  SDL_TLSID mWorkerIndex;
+
+  // Job storage handed out during a frame
+  LJob* mPool;
+  SDL_atomic_t mPoolUsed;
+
+  // Jobs run by each worker and jobs taken from another worker's queue
+  SDL_atomic_t mExecuted[LJOBS_MAX_WORKERS + 1];
+  SDL_atomic_t mStolen;
+} LJobs;
+
+// Arguments of a worker thread
+typedef struct LJobsWorker {
+  LJobs* mJobs;
+  int mIndex;
+} LJobsWorker;
+
+LJobs LJobsNew() {
+  LJobs lJobs;
+  memset( &lJobs, 0, sizeof( lJobs ) );
+  return lJobs;
+}
+
+LJobCounter LJobCounterNew() {
+  LJobCounter lJobCounter;
+  memset( &lJobCounter, 0, sizeof( lJobCounter ) );
+  return lJobCounter;
+}
+
+// Index of the calling worker, 0 for threads that aren't workers
+static int LJobsCurrentWorker( LJobs* lJobs ) {
+  void* value = SDL_TLSGet( lJobs->mWorkerIndex );
+  return value != NULL ? (int)(uintptr_t)value - 1 : 0;
+}
+
+// Adds job at the bottom of queue, returns false when full
+static bool LJobsPush( LJobQueue* queue, LJob* job ) {
+  bool pushed = false;
+  SDL_AtomicLock( &queue->mLock );
+  if ( queue->mBottom - queue->mTop < LJOBS_QUEUE_SIZE ) {
+    queue->mJobs[queue->mBottom & ( LJOBS_QUEUE_SIZE - 1 )] = job;
+    ++queue->mBottom;
+    pushed = true;
+  }
+  SDL_AtomicUnlock( &queue->mLock );
+  return pushed;
+}
+
+// Takes newest job from the bottom of own queue
+static LJob* LJobsPop( LJobQueue* queue ) {
+  LJob* job = NULL;
+  SDL_AtomicLock( &queue->mLock );
+  if ( queue->mBottom != queue->mTop ) {
+    --queue->mBottom;
+    job = queue->mJobs[queue->mBottom & ( LJOBS_QUEUE_SIZE - 1 )];
+  }
+  SDL_AtomicUnlock( &queue->mLock );
+  return job;
+}
+
+// Takes oldest job from the top of another worker's queue
+static LJob* LJobsSteal( LJobQueue* queue ) {
+  LJob* job = NULL;
+  SDL_AtomicLock( &queue->mLock );
+  if ( queue->mBottom != queue->mTop ) {
+    job = queue->mJobs[queue->mTop & ( LJOBS_QUEUE_SIZE - 1 )];
+    ++queue->mTop;
+  }
+  SDL_AtomicUnlock( &queue->mLock );
+  return job;
+}
+
+// Finds job for worker, own queue first
+static LJob* LJobsFind( LJobs* lJobs, int worker ) {
+  LJob* job = LJobsPop( &lJobs->mQueues[worker] );
+  for ( int i = 1; job == NULL && i < lJobs->mWorkerCount; ++i ) {
+    job = LJobsSteal( &lJobs->mQueues[( worker + i ) % lJobs->mWorkerCount] );
+    if ( job != NULL ) {
+      SDL_AtomicIncRef( &lJobs->mStolen );
+    }
+  }
+  return job;
+}
+
+static void LJobsRun( LJobs* lJobs, LJob* job, int worker );
+
+// Makes job runnable on the calling worker
+static void LJobsSchedule( LJobs* lJobs, LJob* job ) {
+  int worker = LJobsCurrentWorker( lJobs );
+  if ( lJobs->mQueues == NULL ||
+       !LJobsPush( &lJobs->mQueues[worker], job ) ) {
+    // No room, run it right here
+    LJobsRun( lJobs, job, worker );
+    return;
+  }
+  if ( lJobs->mWorkerCount > 1 ) {
+    SDL_SemPost( lJobs->mWake );
+  }
+}
+
+// Runs job and releases jobs waiting on its counter
+static void LJobsRun( LJobs* lJobs, LJob* job, int worker ) {
+  if ( job->mFunction != NULL ) {
+    job->mFunction( job->mData );
+  } else {
+    job->mRangeFunction( job->mData, job->mBegin, job->mEnd );
+  }
+  SDL_AtomicIncRef( &lJobs->mExecuted[worker] );
+
+  // Counter may live on the waiter's stack, so it isn't touched after the
+  // unlock that follows the last decrement
+  LJobCounter* signal = job->mSignal;
+  if ( signal != NULL ) {
+    LJob* waiting = NULL;
+    SDL_AtomicLock( &signal->mLock );
+    if ( SDL_AtomicDecRef( &signal->mPending ) ) {
+      waiting = signal->mWaiting;
+      signal->mWaiting = NULL;
+    }
+    SDL_AtomicUnlock( &signal->mLock );
+
+    while ( waiting != NULL ) {
+      LJob* next = waiting->mNext;
+      LJobsSchedule( lJobs, waiting );
+      waiting = next;
+    }
+  }
+}
+
+// Runs jobs until shutdown
+static int LJobsThread( void* data ) {
+  LJobsWorker* worker = (LJobsWorker*)data;
+  LJobs* lJobs = worker->mJobs;
+  int index = worker->mIndex;
+  free( worker );
+  SDL_TLSSet( lJobs->mWorkerIndex, (void*)(uintptr_t)( index + 1 ), NULL );
+
+  while ( !SDL_AtomicGet( &lJobs->mQuit ) ) {
+    LJob* job = LJobsFind( lJobs, index );
+    if ( job != NULL ) {
+      LJobsRun( lJobs, job, index );
+    } else {
+      // Timeout covers a wake up posted just before we started waiting
+      SDL_SemWaitTimeout( lJobs->mWake, 1 );
+    }
+  }
+  return 0;
+}
+
+bool LJobsStart( LJobs* lJobs, int workerCount ) {
+  if ( workerCount < 1 ) {
+    workerCount = 1;
+  } else if ( workerCount > LJOBS_MAX_WORKERS + 1 ) {
+    workerCount = LJOBS_MAX_WORKERS + 1;
+  }
+
+  lJobs->mQueues =
+      (LJobQueue*)calloc( (size_t)workerCount, sizeof( LJobQueue ) );
+  lJobs->mPool = (LJob*)malloc( sizeof( LJob ) * LJOBS_MAX_JOBS );
+  lJobs->mWake = SDL_CreateSemaphore( 0 );
+  lJobs->mWorkerIndex = SDL_TLSCreate();
+  if ( lJobs->mQueues == NULL || lJobs->mPool == NULL ||
+       lJobs->mWake == NULL || lJobs->mWorkerIndex == 0 ) {
+    printf( "Unable to create job system! SDL Error: %s\n", SDL_GetError() );
+    LJobsFree( lJobs );
+    return false;
+  }
+  SDL_TLSSet( lJobs->mWorkerIndex, (void*)(uintptr_t)1, NULL );
+
+  // Queues all exist before any thread can steal from them, a worker that
+  // fails to start just leaves its queue empty
+  lJobs->mWorkerCount = workerCount;
+  for ( int i = 1; i < workerCount; ++i ) {
+    LJobsWorker* worker = (LJobsWorker*)malloc( sizeof( LJobsWorker ) );
+    if ( worker == NULL ) {
+      printf( "Unable to allocate job worker!\n" );
+      break;
+    }
+    worker->mJobs = lJobs;
+    worker->mIndex = i;
+    lJobs->mThreads[i - 1] = SDL_CreateThread( LJobsThread, "LJobs", worker );
+    if ( lJobs->mThreads[i - 1] == NULL ) {
+      printf( "Unable to start job worker! SDL Error: %s\n", SDL_GetError() );
+      free( worker );
+      break;
+    }
+  }
+  return true;
+}
+
+void LJobsFree( LJobs* lJobs ) {
+  // Stop workers
+  SDL_AtomicSet( &lJobs->mQuit, 1 );
+  for ( int i = 0; i < LJOBS_MAX_WORKERS; ++i ) {
+    if ( lJobs->mThreads[i] != NULL ) {
+      SDL_SemPost( lJobs->mWake );
+    }
+  }
+  for ( int i = 0; i < LJOBS_MAX_WORKERS; ++i ) {
+    if ( lJobs->mThreads[i] != NULL ) {
+      SDL_WaitThread( lJobs->mThreads[i], NULL );
+    }
+  }
+
+  if ( lJobs->mWake != NULL ) {
+    SDL_DestroySemaphore( lJobs->mWake );
+  }
+  if ( lJobs->mWorkerIndex != 0 ) {
+    SDL_TLSSet( lJobs->mWorkerIndex, NULL, NULL );
+  }
+  free( lJobs->mQueues );
+  free( lJobs->mPool );
+  *lJobs = LJobsNew();
+}
+
+// Hands out job storage for this frame, NULL when exhausted
+static LJob* LJobsAllocate( LJobs* lJobs ) {
+  if ( lJobs->mPool == NULL ) {
+    return NULL;
+  }
+  int index = SDL_AtomicAdd( &lJobs->mPoolUsed, 1 );
+  return index < LJOBS_MAX_JOBS ? &lJobs->mPool[index] : NULL;
+}
+
+// Queues prepared job, or holds it back until after reaches zero
+static void LJobsEnqueue( LJobs* lJobs, LJob* job, LJobCounter* after ) {
+  if ( job->mSignal != NULL ) {
+    SDL_AtomicIncRef( &job->mSignal->mPending );
+  }
+
+  if ( after != NULL ) {
+    // Checked under the lock so the last finishing job can't miss us
+    SDL_AtomicLock( &after->mLock );
+    bool held = SDL_AtomicGet( &after->mPending ) > 0;
+    if ( held ) {
+      job->mNext = after->mWaiting;
+      after->mWaiting = job;
+    }
+    SDL_AtomicUnlock( &after->mLock );
+    if ( held ) {
+      return;
+    }
+  }
+
+  LJobsSchedule( lJobs, job );
+}
+
+// Runs job on the spot when the frame ran out of job storage
+static void LJobsRunInline( LJobs* lJobs, LJob* job, LJobCounter* after ) {
+  if ( after != NULL ) {
+    LJobsWait( lJobs, after );
+  }
+  if ( job->mSignal != NULL ) {
+    SDL_AtomicIncRef( &job->mSignal->mPending );
+  }
+  LJobsRun( lJobs, job, LJobsCurrentWorker( lJobs ) );
+}
+
+void LJobsSubmit( LJobs* lJobs, LJobFunction function, void* data,
+                  LJobCounter* signal, LJobCounter* after ) {
+  LJob local;
+  LJob* job = LJobsAllocate( lJobs );
+  bool stored = job != NULL;
+  if ( !stored ) {
+    job = &local;
+  }
+  memset( job, 0, sizeof( LJob ) );
+  job->mFunction = function;
+  job->mData = data;
+  job->mSignal = signal;
+
+  if ( stored ) {
+    LJobsEnqueue( lJobs, job, after );
+  } else {
+    LJobsRunInline( lJobs, job, after );
+  }
+}
+
+void LJobsParallelFor( LJobs* lJobs, LJobRangeFunction function, void* data,
+                       int count, int grain, LJobCounter* signal,
+                       LJobCounter* after ) {
+  if ( grain < 1 ) {
+    grain = 1;
+  }
+  for ( int begin = 0; begin < count; begin += grain ) {
+    LJob local;
+    LJob* job = LJobsAllocate( lJobs );
+    bool stored = job != NULL;
+    if ( !stored ) {
+      job = &local;
+    }
+    memset( job, 0, sizeof( LJob ) );
+    job->mRangeFunction = function;
+    job->mData = data;
+    job->mBegin = begin;
+    job->mEnd = count - begin > grain ? begin + grain : count;
+    job->mSignal = signal;
+
+    if ( stored ) {
+      LJobsEnqueue( lJobs, job, after );
+    } else {
+      LJobsRunInline( lJobs, job, after );
+    }
+  }
+}
+
+// Backs off while other threads finish the last jobs
+static void LJobsIdle( int idle ) {
+  if ( idle < LJOBS_SPIN_LIMIT ) {
+#ifdef SDL_CPUPauseInstruction
+    SDL_CPUPauseInstruction();
+#endif
+  } else {
+    SDL_Delay( 0 );
+  }
+}
+
+void LJobsWait( LJobs* lJobs, LJobCounter* lJobCounter ) {
+  int worker = LJobsCurrentWorker( lJobs );
+  int idle = 0;
+  while ( SDL_AtomicGet( &lJobCounter->mPending ) > 0 ) {
+    // Help instead of blocking
+    LJob* job = lJobs->mQueues != NULL ? LJobsFind( lJobs, worker ) : NULL;
+    if ( job != NULL ) {
+      LJobsRun( lJobs, job, worker );
+      idle = 0;
+    } else {
+      LJobsIdle( idle );
+      idle = SDL_min( idle + 1, LJOBS_SPIN_LIMIT );
+    }
+  }
+
+  // Last job may still hold the lock, the counter is the caller's once it
+  // is released
+  SDL_AtomicLock( &lJobCounter->mLock );
+  SDL_AtomicUnlock( &lJobCounter->mLock );
+}
+
+void LJobsEndFrame( LJobs* lJobs ) {
+  SDL_AtomicSet( &lJobs->mPoolUsed, 0 );
+}
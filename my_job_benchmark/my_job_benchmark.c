@@ -0,0 +1,379 @@
+// Using SDL, standard IO, the job system and frame arenas
+#include "LArena.h"
+#include "LJobs.h"
+
+// Scene dimension constants
+const int WORLD_SIZE = 4096;
+const int VIEW_WIDTH = 640;
+const int VIEW_HEIGHT = 480;
+
+// Benchmark constants
+const int ENTITY_COUNT = 100000;
+const int JOB_GRAIN = 512;
+const int WARMUP_FRAMES = 20;
+const int MEASURED_FRAMES = 200;
+const float FRAME_TIME = 1.0f / 60.0f;
+const size_t FRAME_ARENA_SIZE = 4 * 1024 * 1024;
+
+// Animated, culled and labeled scene object
+typedef struct Entity {
+  float x;
+  float y;
+  float vx;
+  float vy;
+
+  // Sprite animation
+  int frame;
+  float frameTime;
+
+  // Set by culling
+  bool visible;
+
+  // Set by layout, label lives in the frame arena and is NULL while the
+  // entity isn't visible
+  char* label;
+  int labelWidth;
+} Entity;
+
+// Sprite to draw, sorted by animation frame to share texture state
+typedef struct DrawCommand {
+  int entity;
+  int frame;
+} DrawCommand;
+
+// Everything updated per frame
+typedef struct Scene {
+  Entity* entities;
+  int cameraX;
+  int cameraY;
+  int frame;
+
+  // Arena of the frame being built
+  LArena* arena;
+
+  // Draw list of the last built frame, consumed while the next one is built
+  LArena* drawArena;
+  DrawCommand* commands;
+  int commandCount;
+  Uint32 generation;
+} Scene;
+
+// Starts up SDL and allocates the scene
+bool init( void );
+
+// Frees scene and shuts down SDL
+void close( void );
+
+// Steps movement and sprite animation
+void animateEntities( void* data, int begin, int end );
+
+// Moves camera over the world
+void moveCamera( void* data );
+
+// Marks entities inside the view
+void cullEntities( void* data, int begin, int end );
+
+// Builds labels of visible entities
+void layoutEntities( void* data, int begin, int end );
+
+// Sorts visible entities into a draw list
+void buildDrawList( void );
+
+// Walks previous frame's draw list the way a renderer would, returns checksum
+int consumeDrawList( void );
+
+// Updates one frame as a graph of jobs
+void updateFrame( LJobs* lJobs );
+
+// Measures average frame time with given number of workers
+double benchmark( int workerCount, int* stolen, int* heapAllocations );
+
+// The scene
+Scene gScene;
+
+// Per frame allocations
+LFrameArena gFrameArena;
+
+bool init() {
+  // Initialize SDL
+  if ( SDL_Init( 0 ) < 0 ) {
+    printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  gScene.entities =
+      (Entity*)malloc( sizeof( Entity ) * (size_t)ENTITY_COUNT );
+  if ( gScene.entities == NULL ) {
+    printf( "Unable to allocate entities!\n" );
+    return false;
+  }
+
+  gFrameArena = LFrameArenaNew( FRAME_ARENA_SIZE );
+  if ( gFrameArena.mArenas[0].mMemory == NULL ||
+       gFrameArena.mArenas[1].mMemory == NULL ) {
+    return false;
+  }
+  return true;
+}
+
+void close() {
+  free( gScene.entities );
+  gScene.entities = NULL;
+  LFrameArenaFree( &gFrameArena );
+
+  // Quit SDL subsystems
+  SDL_Quit();
+}
+
+// Puts entities back where every run starts
+static void resetScene( void ) {
+  srand( 1 );
+  for ( int i = 0; i < ENTITY_COUNT; ++i ) {
+    Entity* entity = &gScene.entities[i];
+    memset( entity, 0, sizeof( Entity ) );
+    entity->x = (float)( rand() % WORLD_SIZE );
+    entity->y = (float)( rand() % WORLD_SIZE );
+    entity->vx = (float)( rand() % 200 - 100 );
+    entity->vy = (float)( rand() % 200 - 100 );
+    entity->frame = rand() % 4;
+  }
+  gScene.cameraX = 0;
+  gScene.cameraY = 0;
+  gScene.frame = 0;
+  gScene.drawArena = NULL;
+  gScene.commands = NULL;
+  gScene.commandCount = 0;
+}
+
+void animateEntities( void* data, int begin, int end ) {
+  Scene* scene = (Scene*)data;
+  for ( int i = begin; i < end; ++i ) {
+    Entity* entity = &scene->entities[i];
+
+    // Move and bounce off world edges
+    entity->x += entity->vx * FRAME_TIME;
+    entity->y += entity->vy * FRAME_TIME;
+    if ( entity->x < 0 || entity->x >= (float)WORLD_SIZE ) {
+      entity->vx = -entity->vx;
+      entity->x += 2 * entity->vx * FRAME_TIME;
+    }
+    if ( entity->y < 0 || entity->y >= (float)WORLD_SIZE ) {
+      entity->vy = -entity->vy;
+      entity->y += 2 * entity->vy * FRAME_TIME;
+    }
+
+    // Four frame walk cycle at 10 frames per second
+    entity->frameTime += FRAME_TIME;
+    while ( entity->frameTime >= 0.1f ) {
+      entity->frameTime -= 0.1f;
+      entity->frame = ( entity->frame + 1 ) % 4;
+    }
+  }
+}
+
+void moveCamera( void* data ) {
+  Scene* scene = (Scene*)data;
+  ++scene->frame;
+  scene->cameraX = ( scene->frame * 7 ) % ( WORLD_SIZE - VIEW_WIDTH );
+  scene->cameraY = ( scene->frame * 3 ) % ( WORLD_SIZE - VIEW_HEIGHT );
+}
+
+void cullEntities( void* data, int begin, int end ) {
+  Scene* scene = (Scene*)data;
+  for ( int i = begin; i < end; ++i ) {
+    Entity* entity = &scene->entities[i];
+    entity->visible = entity->x + 32 >= (float)scene->cameraX &&
+                      entity->x < (float)( scene->cameraX + VIEW_WIDTH ) &&
+                      entity->y + 32 >= (float)scene->cameraY &&
+                      entity->y < (float)( scene->cameraY + VIEW_HEIGHT );
+  }
+}
+
+void layoutEntities( void* data, int begin, int end ) {
+  Scene* scene = (Scene*)data;
+  for ( int i = begin; i < end; ++i ) {
+    Entity* entity = &scene->entities[i];
+    if ( !entity->visible ) {
+      // Last label is released with its frame's arena
+      entity->label = NULL;
+      entity->labelWidth = 0;
+      continue;
+    }
+
+    // Format label into the frame arena
+    char text[32];
+    int length = snprintf( text, sizeof( text ), "Unit %d (%d, %d)", i,
+                           (int)entity->x, (int)entity->y );
+    entity->label = (char*)LArenaAlloc( scene->arena, (size_t)length + 1, 1 );
+    if ( entity->label == NULL ) {
+      entity->labelWidth = 0;
+      continue;
+    }
+    memcpy( entity->label, text, (size_t)length + 1 );
+
+    // Measure label with a monospaced digit and proportional letter advance
+    int width = 0;
+    for ( const char* c = entity->label; *c != '\0'; ++c ) {
+      width += *c >= '0' && *c <= '9' ? 9 : *c == ' ' ? 4 : 7;
+    }
+    entity->labelWidth = width;
+  }
+}
+
+void buildDrawList() {
+  // Count sprites per animation frame
+  int counts[4] = { 0, 0, 0, 0 };
+  int visible = 0;
+  for ( int i = 0; i < ENTITY_COUNT; ++i ) {
+    if ( gScene.entities[i].visible ) {
+      ++counts[gScene.entities[i].frame];
+      ++visible;
+    }
+  }
+
+  gScene.commands = (DrawCommand*)LArenaAlloc(
+      gScene.arena, sizeof( DrawCommand ) * (size_t)( visible + 1 ),
+      sizeof( int ) );
+  gScene.commandCount = 0;
+  gScene.drawArena = gScene.arena;
+  gScene.generation = LArenaGeneration( gScene.arena );
+  if ( gScene.commands == NULL ) {
+    return;
+  }
+
+  // Place each frame's sprites after the previous frame's
+  int starts[4] = { 0, counts[0], counts[0] + counts[1],
+                    counts[0] + counts[1] + counts[2] };
+  for ( int i = 0; i < ENTITY_COUNT; ++i ) {
+    if ( gScene.entities[i].visible ) {
+      DrawCommand* command =
+          &gScene.commands[starts[gScene.entities[i].frame]++];
+      command->entity = i;
+      command->frame = gScene.entities[i].frame;
+    }
+  }
+  gScene.commandCount = visible;
+}
+
+int consumeDrawList() {
+  if ( gScene.commands == NULL ) {
+    return 0;
+  }
+
+  // Catch a renderer holding on to a list whose arena was reset
+  SDL_assert( LArenaIsAlive( gScene.drawArena, gScene.generation ) );
+
+  // Labels were laid out in the same frame as the list
+  int checksum = 0;
+  for ( int i = 0; i < gScene.commandCount; ++i ) {
+    const Entity* entity = &gScene.entities[gScene.commands[i].entity];
+    checksum += entity->labelWidth + gScene.commands[i].frame;
+    if ( entity->label != NULL ) {
+      checksum += entity->label[0];
+    }
+  }
+  return checksum;
+}
+
+void updateFrame( LJobs* lJobs ) {
+  // Transient data of two frames ago is released here
+  gScene.arena = LFrameArenaBegin( &gFrameArena );
+
+  // Draw last frame while its arena is still alive, before jobs change the
+  // entities it refers to
+  consumeDrawList();
+
+  LJobCounter animated = LJobCounterNew();
+  LJobCounter culled = LJobCounterNew();
+  LJobCounter laidOut = LJobCounterNew();
+
+  // Animation and camera are independent, culling needs both, layout needs
+  // culling
+  LJobsParallelFor( lJobs, animateEntities, &gScene, ENTITY_COUNT, JOB_GRAIN,
+                    &animated, NULL );
+  LJobsSubmit( lJobs, moveCamera, &gScene, &animated, NULL );
+  LJobsParallelFor( lJobs, cullEntities, &gScene, ENTITY_COUNT, JOB_GRAIN,
+                    &culled, &animated );
+  LJobsParallelFor( lJobs, layoutEntities, &gScene, ENTITY_COUNT, JOB_GRAIN,
+                    &laidOut, &culled );
+
+  LJobsWait( lJobs, &laidOut );
+  LJobsEndFrame( lJobs );
+
+  buildDrawList();
+}
+
+// Heap allocations both frame arenas fell back to so far
+static int frameArenaHeapAllocations( void ) {
+  return SDL_AtomicGet( &gFrameArena.mArenas[0].mHeapAllocations ) +
+         SDL_AtomicGet( &gFrameArena.mArenas[1].mHeapAllocations );
+}
+
+double benchmark( int workerCount, int* stolen, int* heapAllocations ) {
+  LJobs jobs = LJobsNew();
+  if ( !LJobsStart( &jobs, workerCount ) ) {
+    return -1.0;
+  }
+  resetScene();
+
+  for ( int i = 0; i < WARMUP_FRAMES; ++i ) {
+    updateFrame( &jobs );
+  }
+  SDL_AtomicSet( &jobs.mStolen, 0 );
+  int heapBefore = frameArenaHeapAllocations();
+
+  Uint64 start = SDL_GetPerformanceCounter();
+  for ( int i = 0; i < MEASURED_FRAMES; ++i ) {
+    updateFrame( &jobs );
+  }
+  Uint64 end = SDL_GetPerformanceCounter();
+
+  *stolen = SDL_AtomicGet( &jobs.mStolen );
+  *heapAllocations = frameArenaHeapAllocations() - heapBefore;
+  LJobsFree( &jobs );
+  return (double)( end - start ) * 1000.0 /
+         (double)SDL_GetPerformanceFrequency() / (double)MEASURED_FRAMES;
+}
+
+int main() {
+  // Start up SDL and allocate scene
+  if ( !init() ) {
+    printf( "Failed to initialize!\n" );
+  } else {
+    int cores = SDL_GetCPUCount();
+    printf( "%d entities, %d cores\n", ENTITY_COUNT, cores );
+    // Arena spills count only requests the frame arenas passed on to malloc,
+    // not every heap allocation a frame makes. Job storage and queues are
+    // allocated once when the workers start
+    printf( "workers  ms/frame  speedup  stolen/frame  arena spills\n" );
+
+    // Frame time against number of workers
+    double baseline = 0.0;
+    for ( int workers = 1; workers <= cores; ++workers ) {
+      int stolen = 0;
+      int heapAllocations = 0;
+      double frameTime = benchmark( workers, &stolen, &heapAllocations );
+      if ( frameTime < 0.0 ) {
+        printf( "Failed to start %d workers!\n", workers );
+        break;
+      }
+      if ( workers == 1 ) {
+        baseline = frameTime;
+      }
+      printf( "%7d  %8.3f  %6.2fx  %12.1f  %12d\n", workers, frameTime,
+              baseline / frameTime, (double)stolen / MEASURED_FRAMES,
+              heapAllocations );
+    }
+
+    // Arena size needed by the busiest frame
+    size_t peak = SDL_max( gFrameArena.mArenas[0].mPeak,
+                           gFrameArena.mArenas[1].mPeak );
+    printf( "Frame arena peak %lu of %lu bytes\n", (unsigned long)peak,
+            (unsigned long)FRAME_ARENA_SIZE );
+  }
+
+  // Free resources and close SDL
+  close();
+
+  return 0;
+}
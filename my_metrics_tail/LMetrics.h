@@ -0,0 +1,430 @@
+#ifndef LMETRICS_H
+#define LMETRICS_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// The tutorials define their own close(), which both hides unistd.h's and
+// takes its symbol, so the C library's is reached through an alias
+#if defined( __GLIBC__ )
+int LMetricsLibcClose( int descriptor ) __asm__( "__close" );
+#define LMETRICS_LIBC_CLOSE
+#elif defined( __APPLE__ )
+int LMetricsLibcClose( int descriptor ) __asm__( "_close$NOCANCEL" );
+#define LMETRICS_LIBC_CLOSE
+#endif
+#endif
+
+// Metrics and readers one LMetrics can hold
+#define LMETRICS_MAX 32
+#define LMETRICS_MAX_CLIENTS 8
+
+// Longest snapshot line
+#define LMETRICS_LINE_SIZE 1024
+
+// Format version leading every snapshot line
+#define LMETRICS_VERSION 1
+
+// Socket used when LMETRICS_SOCKET isn't set
+#define LMETRICS_DEFAULT_SOCKET "/tmp/sdl_tutorials.metrics"
+
+// How a metric is reported
+typedef enum LMetricKind {
+  // Running total, reported as its increase per second
+  LMETRIC_COUNTER,
+
+  // Last value set
+  LMETRIC_GAUGE,
+
+  // Observations, reported as mean and max over the period
+  LMETRIC_TIMING
+} LMetricKind;
+
+// Named value being published
+typedef struct LMetric LMetric;
+
+// Publishes a snapshot of registered metrics once per second to every reader
+// connected to a local Unix domain socket. A snapshot is one text line of
+//   lmetrics <version> seq=<n> period_ms=<ms> <name>=<value>...
+// with metrics in registration order and timings split into <name>_avg and
+// <name>_max, so readers can rely on the keys staying put. Recording a
+// value is a store, and publishing never blocks: a reader too slow to take
+// a whole line is dropped
+typedef struct LMetrics LMetrics;
+
+// creates LMetrics with frame time and rate already registered
+LMetrics LMetricsNew( void );
+
+// Listens for readers on socket at path, replacing a stale one
+// A socket another program still listens on is left alone
+bool LMetricsStart( LMetrics* lMetrics, const char* path );
+
+// Disconnects readers and removes socket
+void LMetricsFree( LMetrics* lMetrics );
+
+// Registers metric, returns its id or -1 when full
+int LMetricsRegister( LMetrics* lMetrics, const char* name, LMetricKind kind );
+
+// Adds to counter
+void LMetricsAdd( LMetrics* lMetrics, int id, double amount );
+
+// Sets gauge or counter total
+void LMetricsSet( LMetrics* lMetrics, int id, double value );
+
+// Records timing observation
+void LMetricsSample( LMetrics* lMetrics, int id, double value );
+
+// Ends frame, timing it and publishing a snapshot once a second passed
+void LMetricsFrame( LMetrics* lMetrics );
+
+// Opens reader on metrics socket at path, NULL if nothing publishes there
+FILE* LMetricsConnect( const char* path );
+
+typedef struct LMetric {
+  const char* mName;
+  LMetricKind mKind;
+
+  // Counter total, gauge value or sum of observations
+  double mValue;
+
+  // Counter total at the last snapshot
+  double mLast;
+
+  // Observations this period and the largest
+  Uint32 mSamples;
+  double mMax;
+} LMetric;
+
+typedef struct LMetrics {
+  LMetric mMetrics[LMETRICS_MAX];
+  int mMetricCount;
+
+  // Built in metrics
+  int mFrameTime;
+  int mFrames;
+
+  // Listening socket and connected readers, NULL when not started
+  // Descriptors are held as streams so fclose releases them, since the
+  // tutorials define their own close()
+  FILE* mListener;
+  FILE* mClients[LMETRICS_MAX_CLIENTS];
+  char mPath[108];
+
+  // Performance counter at start of period and frame
+  Uint64 mPeriodStart;
+  Uint64 mFrameStart;
+  Uint32 mSequence;
+} LMetrics;
+
+LMetrics LMetricsNew() {
+  LMetrics lMetrics;
+  memset( &lMetrics, 0, sizeof( lMetrics ) );
+  lMetrics.mFrameTime =
+      LMetricsRegister( &lMetrics, "frame_ms", LMETRIC_TIMING );
+  lMetrics.mFrames = LMetricsRegister( &lMetrics, "fps", LMETRIC_COUNTER );
+  return lMetrics;
+}
+
+int LMetricsRegister( LMetrics* lMetrics, const char* name, LMetricKind kind ) {
+  if ( lMetrics->mMetricCount == LMETRICS_MAX ) {
+    printf( "Unable to register metric %s! Too many metrics\n", name );
+    return -1;
+  }
+  LMetric* metric = &lMetrics->mMetrics[lMetrics->mMetricCount];
+  memset( metric, 0, sizeof( LMetric ) );
+  metric->mName = name;
+  metric->mKind = kind;
+  return lMetrics->mMetricCount++;
+}
+
+void LMetricsAdd( LMetrics* lMetrics, int id, double amount ) {
+  if ( id >= 0 ) {
+    lMetrics->mMetrics[id].mValue += amount;
+  }
+}
+
+void LMetricsSet( LMetrics* lMetrics, int id, double value ) {
+  if ( id >= 0 ) {
+    lMetrics->mMetrics[id].mValue = value;
+  }
+}
+
+void LMetricsSample( LMetrics* lMetrics, int id, double value ) {
+  if ( id >= 0 ) {
+    LMetric* metric = &lMetrics->mMetrics[id];
+    metric->mValue += value;
+    if ( metric->mSamples == 0 || value > metric->mMax ) {
+      metric->mMax = value;
+    }
+    ++metric->mSamples;
+  }
+}
+
+#ifndef _WIN32
+// Fills address for socket at path
+static bool LMetricsAddress( struct sockaddr_un* address, const char* path ) {
+  memset( address, 0, sizeof( struct sockaddr_un ) );
+  address->sun_family = AF_UNIX;
+  if ( strlen( path ) >= sizeof( address->sun_path ) ) {
+    printf( "Unable to use metrics socket %s! Path is too long\n", path );
+    return false;
+  }
+  strcpy( address->sun_path, path );
+  return true;
+}
+
+// Releases descriptor that never got a stream
+// Without a known alias for close() it's only shut down
+static void LMetricsCloseDescriptor( int descriptor ) {
+#ifdef LMETRICS_LIBC_CLOSE
+  LMetricsLibcClose( descriptor );
+#else
+  shutdown( descriptor, SHUT_RDWR );
+#endif
+}
+
+// Makes socket stream, closing the descriptor if that fails
+static FILE* LMetricsSocket( void ) {
+  int descriptor = socket( AF_UNIX, SOCK_STREAM, 0 );
+  if ( descriptor < 0 ) {
+    printf( "Unable to create metrics socket! %s\n", strerror( errno ) );
+    return NULL;
+  }
+  FILE* stream = fdopen( descriptor, "r+" );
+  if ( stream == NULL ) {
+    printf( "Unable to open metrics socket! %s\n", strerror( errno ) );
+    LMetricsCloseDescriptor( descriptor );
+  }
+  return stream;
+}
+
+// Removes socket at path left behind by a run that didn't clean up
+// Only sockets nobody accepts connections on anymore are removed
+static void LMetricsRemoveStale( const struct sockaddr_un* address,
+                                 const char* path ) {
+  struct stat status;
+  if ( lstat( path, &status ) != 0 || !S_ISSOCK( status.st_mode ) ) {
+    return;
+  }
+
+  FILE* probe = LMetricsSocket();
+  if ( probe == NULL ) {
+    return;
+  }
+  bool stale = connect( fileno( probe ), (const struct sockaddr*)address,
+                        sizeof( struct sockaddr_un ) ) != 0 &&
+               errno == ECONNREFUSED;
+  fclose( probe );
+  if ( stale ) {
+    remove( path );
+  }
+}
+#endif
+
+bool LMetricsStart( LMetrics* lMetrics, const char* path ) {
+#ifndef _WIN32
+  struct sockaddr_un address;
+  if ( !LMetricsAddress( &address, path ) ) {
+    return false;
+  }
+
+  // Socket left behind by a previous run would make bind fail
+  LMetricsRemoveStale( &address, path );
+
+  FILE* listener = LMetricsSocket();
+  if ( listener == NULL ) {
+    return false;
+  }
+  int descriptor = fileno( listener );
+  if ( bind( descriptor, (struct sockaddr*)&address, sizeof( address ) ) !=
+           0 ||
+       listen( descriptor, LMETRICS_MAX_CLIENTS ) != 0 ||
+       fcntl( descriptor, F_SETFL, O_NONBLOCK ) != 0 ) {
+    printf( "Unable to listen on metrics socket %s! %s\n", path,
+            strerror( errno ) );
+    fclose( listener );
+    return false;
+  }
+
+  lMetrics->mListener = listener;
+  strcpy( lMetrics->mPath, path );
+  lMetrics->mPeriodStart = SDL_GetPerformanceCounter();
+  lMetrics->mFrameStart = lMetrics->mPeriodStart;
+  return true;
+#else
+  printf( "Unable to publish metrics to %s! Unix sockets unsupported\n",
+          path );
+  return false;
+#endif
+}
+
+void LMetricsFree( LMetrics* lMetrics ) {
+  for ( int i = 0; i < LMETRICS_MAX_CLIENTS; ++i ) {
+    if ( lMetrics->mClients[i] != NULL ) {
+      fclose( lMetrics->mClients[i] );
+    }
+  }
+  if ( lMetrics->mListener != NULL ) {
+    fclose( lMetrics->mListener );
+    remove( lMetrics->mPath );
+  }
+  *lMetrics = LMetricsNew();
+}
+
+#ifndef _WIN32
+// Takes every pending reader without waiting
+static void LMetricsAccept( LMetrics* lMetrics ) {
+  for ( ;; ) {
+    int descriptor = accept( fileno( lMetrics->mListener ), NULL, NULL );
+    if ( descriptor < 0 ) {
+      return;
+    }
+
+    FILE* client = fdopen( descriptor, "r+" );
+    if ( client == NULL ) {
+      LMetricsCloseDescriptor( descriptor );
+      continue;
+    }
+#ifdef SO_NOSIGPIPE
+    // A reader going away shouldn't kill the program
+    int on = 1;
+    setsockopt( descriptor, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof( on ) );
+#endif
+
+    int slot = 0;
+    while ( slot < LMETRICS_MAX_CLIENTS && lMetrics->mClients[slot] != NULL ) {
+      ++slot;
+    }
+    if ( slot == LMETRICS_MAX_CLIENTS ) {
+      fclose( client );
+    } else {
+      lMetrics->mClients[slot] = client;
+    }
+  }
+}
+
+// Sends line to every reader, dropping those that can't take all of it
+static void LMetricsSend( LMetrics* lMetrics, const char* line,
+                          size_t length ) {
+#ifdef MSG_NOSIGNAL
+  int flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+#else
+  int flags = MSG_DONTWAIT;
+#endif
+  for ( int i = 0; i < LMETRICS_MAX_CLIENTS; ++i ) {
+    FILE* client = lMetrics->mClients[i];
+    if ( client != NULL &&
+         send( fileno( client ), line, length, flags ) != (ssize_t)length ) {
+      fclose( client );
+      lMetrics->mClients[i] = NULL;
+    }
+  }
+}
+
+// Formats snapshot of the period and starts the next one
+static size_t LMetricsSnapshot( LMetrics* lMetrics, char* line,
+                                double seconds ) {
+  int length = snprintf( line, LMETRICS_LINE_SIZE,
+                         "lmetrics %d seq=%u period_ms=%.1f", LMETRICS_VERSION,
+                         lMetrics->mSequence++, seconds * 1000.0 );
+  for ( int i = 0; i < lMetrics->mMetricCount; ++i ) {
+    LMetric* metric = &lMetrics->mMetrics[i];
+    size_t left = (size_t)( LMETRICS_LINE_SIZE - length );
+    switch ( metric->mKind ) {
+    case LMETRIC_COUNTER:
+      length += snprintf( line + length, left, " %s=%.1f", metric->mName,
+                          ( metric->mValue - metric->mLast ) / seconds );
+      metric->mLast = metric->mValue;
+      break;
+
+    case LMETRIC_GAUGE:
+      length += snprintf( line + length, left, " %s=%g", metric->mName,
+                          metric->mValue );
+      break;
+
+    case LMETRIC_TIMING:
+      length += snprintf( line + length, left, " %s_avg=%.3f %s_max=%.3f",
+                          metric->mName,
+                          metric->mSamples > 0
+                              ? metric->mValue / (double)metric->mSamples
+                              : 0.0,
+                          metric->mName, metric->mMax );
+      metric->mValue = 0.0;
+      metric->mMax = 0.0;
+      metric->mSamples = 0;
+      break;
+    }
+    if ( length >= LMETRICS_LINE_SIZE - 1 ) {
+      length = LMETRICS_LINE_SIZE - 2;
+      break;
+    }
+  }
+  line[length++] = '\n';
+  line[length] = '\0';
+  return (size_t)length;
+}
+#endif
+
+void LMetricsFrame( LMetrics* lMetrics ) {
+  if ( lMetrics->mListener == NULL ) {
+    return;
+  }
+
+  // Time frame since the previous call
+  Uint64 now = SDL_GetPerformanceCounter();
+  double frequency = (double)SDL_GetPerformanceFrequency();
+  LMetricsSample( lMetrics, lMetrics->mFrameTime,
+                  (double)( now - lMetrics->mFrameStart ) * 1000.0 /
+                      frequency );
+  LMetricsAdd( lMetrics, lMetrics->mFrames, 1 );
+  lMetrics->mFrameStart = now;
+
+  double seconds = (double)( now - lMetrics->mPeriodStart ) / frequency;
+  if ( seconds < 1.0 ) {
+    return;
+  }
+  lMetrics->mPeriodStart = now;
+
+#ifndef _WIN32
+  char line[LMETRICS_LINE_SIZE];
+  size_t length = LMetricsSnapshot( lMetrics, line, seconds );
+  LMetricsAccept( lMetrics );
+  LMetricsSend( lMetrics, line, length );
+#endif
+}
+
+FILE* LMetricsConnect( const char* path ) {
+#ifndef _WIN32
+  struct sockaddr_un address;
+  if ( !LMetricsAddress( &address, path ) ) {
+    return NULL;
+  }
+  FILE* stream = LMetricsSocket();
+  if ( stream != NULL &&
+       connect( fileno( stream ), (struct sockaddr*)&address,
+                sizeof( address ) ) != 0 ) {
+    // Publisher not running yet isn't worth a message
+    if ( errno != ENOENT && errno != ECONNREFUSED ) {
+      printf( "Unable to connect to metrics socket %s! %s\n", path,
+              strerror( errno ) );
+    }
+    fclose( stream );
+    return NULL;
+  }
+  return stream;
+#else
+  printf( "Unable to read metrics from %s! Unix sockets unsupported\n",
+          path );
+  return NULL;
+#endif
+}
+
+#endif
@@ -0,0 +1,184 @@
+// Using SDL, standard IO, strings and the metrics socket
+#include "LMetrics.h"
+#include <stdlib.h>
+
+// Snapshots printed between repeated headers
+const int HEADER_INTERVAL = 20;
+
+// Narrowest column
+const int COLUMN_WIDTH = 9;
+
+// Most columns in one snapshot
+#define MAX_COLUMNS 64
+
+// Snapshot split into keys and values
+typedef struct Snapshot {
+  char* keys[MAX_COLUMNS];
+  char* values[MAX_COLUMNS];
+  int count;
+} Snapshot;
+
+// Starts up SDL
+bool init( void );
+
+// Shuts down SDL
+void close( void );
+
+// Splits snapshot line into key value pairs in place, false if it isn't one
+bool parseSnapshot( char* line, Snapshot* snapshot );
+
+// Whether two snapshots have the same keys in the same order
+bool sameKeys( const Snapshot* a, const Snapshot* b );
+
+// Prints snapshot as a table row, with a header first if requested
+void printSnapshot( const Snapshot* snapshot, bool header );
+
+// Reads snapshots until the publisher goes away
+void tail( FILE* stream, bool raw );
+
+bool init() {
+  // Initialize SDL
+  if ( SDL_Init( 0 ) < 0 ) {
+    printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+  return true;
+}
+
+void close() {
+  // Quit SDL subsystems
+  SDL_Quit();
+}
+
+bool parseSnapshot( char* line, Snapshot* snapshot ) {
+  snapshot->count = 0;
+
+  // Check format name and version
+  char* token = strtok( line, " \n" );
+  if ( token == NULL || strcmp( token, "lmetrics" ) != 0 ) {
+    return false;
+  }
+  token = strtok( NULL, " \n" );
+  if ( token == NULL || atoi( token ) != LMETRICS_VERSION ) {
+    printf( "Unsupported metrics version %s\n", token != NULL ? token : "" );
+    return false;
+  }
+
+  while ( ( token = strtok( NULL, " \n" ) ) != NULL &&
+          snapshot->count < MAX_COLUMNS ) {
+    char* equals = strchr( token, '=' );
+    if ( equals == NULL ) {
+      continue;
+    }
+    *equals = '\0';
+    snapshot->keys[snapshot->count] = token;
+    snapshot->values[snapshot->count] = equals + 1;
+    ++snapshot->count;
+  }
+  return true;
+}
+
+bool sameKeys( const Snapshot* a, const Snapshot* b ) {
+  if ( a->count != b->count ) {
+    return false;
+  }
+  for ( int i = 0; i < a->count; ++i ) {
+    if ( strcmp( a->keys[i], b->keys[i] ) != 0 ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void printSnapshot( const Snapshot* snapshot, bool header ) {
+  if ( header ) {
+    for ( int i = 0; i < snapshot->count; ++i ) {
+      printf( "%*s ", COLUMN_WIDTH, snapshot->keys[i] );
+    }
+    printf( "\n" );
+  }
+
+  // Keep each value under its key
+  for ( int i = 0; i < snapshot->count; ++i ) {
+    int width = (int)strlen( snapshot->keys[i] );
+    printf( "%*s ", SDL_max( width, COLUMN_WIDTH ), snapshot->values[i] );
+  }
+  printf( "\n" );
+  fflush( stdout );
+}
+
+void tail( FILE* stream, bool raw ) {
+  // Lines and keys of the previous snapshot, keys point into its line
+  char lines[2][LMETRICS_LINE_SIZE];
+  Snapshot snapshots[2];
+  int current = 0;
+  int rows = 0;
+  snapshots[1].count = -1;
+
+  while ( fgets( lines[current], LMETRICS_LINE_SIZE, stream ) != NULL ) {
+    if ( raw ) {
+      fputs( lines[current], stdout );
+      fflush( stdout );
+      continue;
+    }
+
+    Snapshot* snapshot = &snapshots[current];
+    if ( !parseSnapshot( lines[current], snapshot ) ) {
+      continue;
+    }
+
+    // Repeat header periodically and whenever the publisher's metrics change
+    bool header = rows % HEADER_INTERVAL == 0 ||
+                  !sameKeys( snapshot, &snapshots[current ^ 1] );
+    if ( header ) {
+      rows = 0;
+    }
+    printSnapshot( snapshot, header );
+    ++rows;
+    current ^= 1;
+  }
+}
+
+int main( int argc, char* argv[] ) {
+  // Socket to read and whether to print lines unparsed
+  const char* path = LMETRICS_DEFAULT_SOCKET;
+  bool raw = false;
+  for ( int i = 1; i < argc; ++i ) {
+    if ( strcmp( argv[i], "--raw" ) == 0 ) {
+      raw = true;
+    } else {
+      path = argv[i];
+    }
+  }
+
+  // Start up SDL
+  if ( !init() ) {
+    printf( "Failed to initialize!\n" );
+  } else {
+    // Follow publisher across restarts until interrupted
+    bool waiting = false;
+    for ( ;; ) {
+      FILE* stream = LMetricsConnect( path );
+      if ( stream == NULL ) {
+        if ( !waiting ) {
+          printf( "Waiting for metrics on %s\n", path );
+          fflush( stdout );
+          waiting = true;
+        }
+        SDL_Delay( 1000 );
+        continue;
+      }
+
+      waiting = false;
+      tail( stream, raw );
+      fclose( stream );
+      printf( "Publisher closed %s\n", path );
+      fflush( stdout );
+    }
+  }
+
+  // Shut down SDL
+  close();
+
+  return 0;
+}
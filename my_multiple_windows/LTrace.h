@@ -0,0 +1,320 @@
+#ifndef LTRACE_H
+#define LTRACE_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Events per buffer chunk, threads chain more chunks as needed
+#define LTRACE_CHUNK_EVENTS 4096
+
+// Longest detail and thread name kept, longer ones are cut
+#define LTRACE_DETAIL_SIZE 48
+#define LTRACE_NAME_SIZE 32
+
+// Begin or end of a span
+typedef struct LTraceEvent LTraceEvent;
+
+// Block of events recorded by one thread
+typedef struct LTraceChunk LTraceChunk;
+
+// Events of one thread, a track on the timeline
+typedef struct LTraceThread LTraceThread;
+
+// Timeline recorder writing Chrome trace event JSON, which chrome://tracing
+// and ui.perfetto.dev open directly. Recording is off unless LTRACE_FILE
+// names the output file, and then each span end is an append to a buffer
+// owned by the calling thread, found through SDL thread local storage, so
+// threads never contend. Everything is written out by LTraceFlush or at exit
+typedef struct LTrace LTrace;
+
+// Enables tracing if LTRACE_FILE is set, returns whether it is
+bool LTraceInit( void );
+
+// Names calling thread's track
+void LTraceThreadName( const char* name );
+
+// Opens span on calling thread, name must outlive the trace
+void LTraceBegin( const char* name );
+
+// Opens span with a detail shown in its arguments, like an asset path
+void LTraceBeginDetail( const char* name, const char* detail );
+
+// Closes calling thread's innermost span
+void LTraceEnd( void );
+
+// Stops tracing and writes trace file once events being recorded on other
+// threads are in, spans they close afterwards are dropped
+void LTraceFlush( void );
+
+typedef struct LTraceEvent {
+  Uint64 mTime;
+  const char* mName;
+
+  // 'B' or 'E'
+  char mPhase;
+  char mDetail[LTRACE_DETAIL_SIZE];
+} LTraceEvent;
+
+typedef struct LTraceChunk {
+  LTraceEvent mEvents[LTRACE_CHUNK_EVENTS];
+  int mCount;
+  LTraceChunk* mNext;
+} LTraceChunk;
+
+typedef struct LTraceThread {
+  SDL_threadID mId;
+  char mName[LTRACE_NAME_SIZE];
+
+  LTraceChunk* mFirst;
+  LTraceChunk* mLast;
+
+  LTraceThread* mNext;
+} LTraceThread;
+
+typedef struct LTrace {
+  // Set while recording, cleared by the flush
+  SDL_atomic_t mEnabled;
+  char mPath[256];
+
+  // Threads that saw tracing enabled and are still appending an event
+  SDL_atomic_t mRecording;
+
+  // Calling thread's LTraceThread
+  SDL_TLSID mThreadKey;
+
+  // Every thread that recorded, guarded by the lock
+  SDL_SpinLock mLock;
+  LTraceThread* mThreads;
+
+  // Performance counter timestamps are relative to
+  Uint64 mStart;
+} LTrace;
+
+// The process wide trace
+static LTrace gLTrace;
+
+// Flushes if the program exits without calling LTraceFlush
+static void LTraceFlushAtExit( void ) {
+  LTraceFlush();
+}
+
+bool LTraceInit() {
+  const char* path = SDL_getenv( "LTRACE_FILE" );
+  if ( SDL_AtomicGet( &gLTrace.mEnabled ) || path == NULL ||
+       path[0] == '\0' ) {
+    return SDL_AtomicGet( &gLTrace.mEnabled ) != 0;
+  }
+
+  gLTrace.mThreadKey = SDL_TLSCreate();
+  if ( gLTrace.mThreadKey == 0 ) {
+    printf( "Unable to create trace storage! SDL Error: %s\n",
+            SDL_GetError() );
+    return false;
+  }
+  snprintf( gLTrace.mPath, sizeof( gLTrace.mPath ), "%s", path );
+  gLTrace.mStart = SDL_GetPerformanceCounter();
+  SDL_AtomicSet( &gLTrace.mEnabled, 1 );
+  atexit( LTraceFlushAtExit );
+  return true;
+}
+
+// Returns calling thread's events, registering the thread on first use
+static LTraceThread* LTraceCurrentThread( void ) {
+  LTraceThread* thread = (LTraceThread*)SDL_TLSGet( gLTrace.mThreadKey );
+  if ( thread != NULL ) {
+    return thread;
+  }
+
+  thread = (LTraceThread*)calloc( 1, sizeof( LTraceThread ) );
+  if ( thread == NULL ) {
+    return NULL;
+  }
+  thread->mId = SDL_ThreadID();
+  snprintf( thread->mName, sizeof( thread->mName ), "thread %lu",
+            (unsigned long)thread->mId );
+  SDL_TLSSet( gLTrace.mThreadKey, thread, NULL );
+
+  SDL_AtomicLock( &gLTrace.mLock );
+  thread->mNext = gLTrace.mThreads;
+  gLTrace.mThreads = thread;
+  SDL_AtomicUnlock( &gLTrace.mLock );
+  return thread;
+}
+
+// Announces calling thread is about to record, false if tracing is off
+// A flush waits for announced threads to leave before taking their buffers
+static bool LTraceEnter( void ) {
+  if ( !SDL_AtomicGet( &gLTrace.mEnabled ) ) {
+    return false;
+  }
+  SDL_AtomicIncRef( &gLTrace.mRecording );
+  if ( !SDL_AtomicGet( &gLTrace.mEnabled ) ) {
+    SDL_AtomicAdd( &gLTrace.mRecording, -1 );
+    return false;
+  }
+  return true;
+}
+
+// Ends recording announced by LTraceEnter
+static void LTraceLeave( void ) {
+  SDL_AtomicAdd( &gLTrace.mRecording, -1 );
+}
+
+// Appends event to calling thread's buffer, call between enter and leave
+static LTraceEvent* LTraceRecord( char phase, const char* name ) {
+  LTraceThread* thread = LTraceCurrentThread();
+  if ( thread == NULL ) {
+    return NULL;
+  }
+
+  // Chain another chunk when the last one is full
+  LTraceChunk* chunk = thread->mLast;
+  if ( chunk == NULL || chunk->mCount == LTRACE_CHUNK_EVENTS ) {
+    chunk = (LTraceChunk*)malloc( sizeof( LTraceChunk ) );
+    if ( chunk == NULL ) {
+      return NULL;
+    }
+    chunk->mCount = 0;
+    chunk->mNext = NULL;
+    if ( thread->mLast != NULL ) {
+      thread->mLast->mNext = chunk;
+    } else {
+      thread->mFirst = chunk;
+    }
+    thread->mLast = chunk;
+  }
+
+  LTraceEvent* event = &chunk->mEvents[chunk->mCount++];
+  event->mTime = SDL_GetPerformanceCounter();
+  event->mName = name;
+  event->mPhase = phase;
+  event->mDetail[0] = '\0';
+  return event;
+}
+
+void LTraceThreadName( const char* name ) {
+  if ( !LTraceEnter() ) {
+    return;
+  }
+  LTraceThread* thread = LTraceCurrentThread();
+  if ( thread != NULL ) {
+    snprintf( thread->mName, sizeof( thread->mName ), "%s", name );
+  }
+  LTraceLeave();
+}
+
+void LTraceBegin( const char* name ) {
+  if ( LTraceEnter() ) {
+    LTraceRecord( 'B', name );
+    LTraceLeave();
+  }
+}
+
+void LTraceBeginDetail( const char* name, const char* detail ) {
+  if ( !LTraceEnter() ) {
+    return;
+  }
+  LTraceEvent* event = LTraceRecord( 'B', name );
+  if ( event != NULL ) {
+    snprintf( event->mDetail, sizeof( event->mDetail ), "%s", detail );
+  }
+  LTraceLeave();
+}
+
+void LTraceEnd() {
+  if ( LTraceEnter() ) {
+    LTraceRecord( 'E', NULL );
+    LTraceLeave();
+  }
+}
+
+// Writes string as JSON string contents
+static void LTraceWriteString( FILE* file, const char* text ) {
+  for ( const char* c = text; *c != '\0'; ++c ) {
+    if ( *c == '"' || *c == '\\' ) {
+      fprintf( file, "\\%c", *c );
+    } else if ( (unsigned char)*c < 0x20 ) {
+      fprintf( file, "\\u%04x", *c );
+    } else {
+      fputc( *c, file );
+    }
+  }
+}
+
+void LTraceFlush() {
+  // Only one flush gets to stop tracing
+  if ( !SDL_AtomicCAS( &gLTrace.mEnabled, 1, 0 ) ) {
+    return;
+  }
+
+  // Let threads finish the event they're appending
+  while ( SDL_AtomicGet( &gLTrace.mRecording ) > 0 ) {
+    SDL_Delay( 0 );
+  }
+
+  FILE* file = fopen( gLTrace.mPath, "w" );
+  if ( file == NULL ) {
+    printf( "Unable to write trace %s!\n", gLTrace.mPath );
+  }
+
+  // One track per thread, timestamps in microseconds
+  double toMicroseconds = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+  bool first = true;
+  if ( file != NULL ) {
+    fprintf( file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" );
+  }
+  SDL_AtomicLock( &gLTrace.mLock );
+  LTraceThread* thread = gLTrace.mThreads;
+  gLTrace.mThreads = NULL;
+  SDL_AtomicUnlock( &gLTrace.mLock );
+  while ( thread != NULL ) {
+    if ( file != NULL ) {
+      fprintf( file,
+               "%s\n{\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"name\":"
+               "\"thread_name\",\"args\":{\"name\":\"",
+               first ? "" : ",", (unsigned long)thread->mId );
+      LTraceWriteString( file, thread->mName );
+      fprintf( file, "\"}}" );
+      first = false;
+    }
+
+    LTraceChunk* chunk = thread->mFirst;
+    while ( chunk != NULL ) {
+      for ( int i = 0; i < chunk->mCount && file != NULL; ++i ) {
+        const LTraceEvent* event = &chunk->mEvents[i];
+        fprintf( file, ",\n{\"ph\":\"%c\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f",
+                 event->mPhase, (unsigned long)thread->mId,
+                 (double)( event->mTime - gLTrace.mStart ) * toMicroseconds );
+        if ( event->mName != NULL ) {
+          fprintf( file, ",\"name\":\"" );
+          LTraceWriteString( file, event->mName );
+          fprintf( file, "\"" );
+        }
+        if ( event->mDetail[0] != '\0' ) {
+          fprintf( file, ",\"args\":{\"detail\":\"" );
+          LTraceWriteString( file, event->mDetail );
+          fprintf( file, "\"}" );
+        }
+        fprintf( file, "}" );
+      }
+      LTraceChunk* next = chunk->mNext;
+      free( chunk );
+      chunk = next;
+    }
+
+    LTraceThread* next = thread->mNext;
+    free( thread );
+    thread = next;
+  }
+
+  if ( file != NULL ) {
+    fprintf( file, "\n]}\n" );
+    fclose( file );
+    printf( "Wrote trace %s\n", gLTrace.mPath );
+  }
+}
+
+#endif
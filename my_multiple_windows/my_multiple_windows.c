@@ -0,0 +1,269 @@
+// Using SDL, SDL_image, standard IO, and the shared texture registry
+#include "LTextureRegistry.h"
+
+// Main window dimension constants, split into two viewports
+const int SCREEN_WIDTH = 640;
+const int SCREEN_HEIGHT = 480;
+
+// Debug window dimension constants
+const int DEBUG_WIDTH = 320;
+const int DEBUG_HEIGHT = 240;
+
+// Degrees the arrows turn per frame
+const double ARROW_SPEED = 2.0;
+
+// Thumbnails of the debug window, each half the size of the one before
+#define THUMBNAIL_COUNT 3
+
+// Images both windows draw
+const char* ARROW_PATH = "15_rotation_and_flipping/arrow.png";
+const char* DOTS_PATH = "11_clip_rendering_and_sprite_sheets/dots.png";
+
+// Window with its own renderer
+typedef struct View {
+  SDL_Window* window;
+  SDL_Renderer* renderer;
+} View;
+
+// Starts up SDL and creates the main window
+bool init( void );
+
+// Creates window and renderer of view, only one view should wait for vsync
+// since views are presented one after another
+bool openView( View* view, const char* title, int width, int height,
+               bool vsync );
+
+// Frees view's textures and destroys its renderer and window
+void closeView( View* view );
+
+// Frees media and shuts down SDL
+void close( void );
+
+// Draws split view, arrow on the left and flipped arrow over dots on the right
+void renderMainView( double angle );
+
+// Draws every image of the debug window
+void renderDebugView( double angle );
+
+// Windows being rendered to, the debug one may be closed
+View gMainView;
+View gDebugView;
+
+// Decoded images shared by both renderers
+LTextureRegistry gTextures;
+
+bool init() {
+  // Initialize SDL
+  if ( SDL_Init( SDL_INIT_VIDEO ) < 0 ) {
+    printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  // Initialize PNG loading
+  int imgFlags = IMG_INIT_PNG;
+  if ( !( IMG_Init( imgFlags ) & imgFlags ) ) {
+    printf( "SDL_image could not initialize! SDL_image Error: %s\n",
+            IMG_GetError() );
+    return false;
+  }
+
+  // Thumbnails of the debug window draw from mip levels
+  gTextures = LTextureRegistryNew();
+  gTextures.mMipmapped = true;
+  return openView( &gMainView, "SDL Tutorial", SCREEN_WIDTH, SCREEN_HEIGHT,
+                   true );
+}
+
+bool openView( View* view, const char* title, int width, int height,
+               bool vsync ) {
+  // Create window
+  view->window =
+      SDL_CreateWindow( title, SDL_WINDOWPOS_UNDEFINED,
+                        SDL_WINDOWPOS_UNDEFINED, width, height,
+                        SDL_WINDOW_SHOWN );
+  if ( view->window == NULL ) {
+    printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  // Create renderer for window, vsynced if asked
+  Uint32 flags = SDL_RENDERER_ACCELERATED;
+  if ( vsync ) {
+    flags |= SDL_RENDERER_PRESENTVSYNC;
+  }
+  view->renderer = SDL_CreateRenderer( view->window, -1, flags );
+  if ( view->renderer == NULL ) {
+    printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+    SDL_DestroyWindow( view->window );
+    view->window = NULL;
+    return false;
+  }
+  return true;
+}
+
+void closeView( View* view ) {
+  // Textures die with their renderer, decoded images stay for other views
+  if ( view->renderer != NULL ) {
+    LTextureRegistryForgetRenderer( &gTextures, view->renderer );
+    SDL_DestroyRenderer( view->renderer );
+    view->renderer = NULL;
+  }
+  if ( view->window != NULL ) {
+    SDL_DestroyWindow( view->window );
+    view->window = NULL;
+  }
+}
+
+void close() {
+  // Report decodes against uploads
+  LTextureRegistryPrintStats( &gTextures );
+
+  // Free loaded images
+  LTextureRegistryFree( &gTextures );
+  LTextureFreeStaging();
+
+  // Destroy windows
+  closeView( &gDebugView );
+  closeView( &gMainView );
+
+  // Quit SDL subsystems
+  IMG_Quit();
+  SDL_Quit();
+}
+
+void renderMainView( double angle ) {
+  SDL_Renderer* renderer = gMainView.renderer;
+  LTexture* arrow = LTextureRegistryGet( &gTextures, renderer, ARROW_PATH );
+  LTexture* dots = LTextureRegistryGet( &gTextures, renderer, DOTS_PATH );
+
+  // Left viewport
+  SDL_Rect leftViewport = { 0, 0, SCREEN_WIDTH / 2, SCREEN_HEIGHT };
+  SDL_RenderSetViewport( renderer, &leftViewport );
+  if ( arrow != NULL ) {
+    LTextureRender( arrow, renderer, ( leftViewport.w - arrow->mWidth ) / 2,
+                    ( leftViewport.h - arrow->mHeight ) / 2, NULL, angle,
+                    NULL, SDL_FLIP_NONE );
+  }
+
+  // Right viewport
+  SDL_Rect rightViewport = { SCREEN_WIDTH / 2, 0, SCREEN_WIDTH / 2,
+                             SCREEN_HEIGHT };
+  SDL_RenderSetViewport( renderer, &rightViewport );
+  if ( dots != NULL ) {
+    SDL_Rect clip = { 0, 0, 100, 100 };
+    LTextureRender( dots, renderer, 0, 0, &clip, 0, NULL, SDL_FLIP_NONE );
+    clip.x = 100;
+    LTextureRender( dots, renderer, rightViewport.w - clip.w,
+                    rightViewport.h - clip.h, &clip, 0, NULL,
+                    SDL_FLIP_NONE );
+  }
+  if ( arrow != NULL ) {
+    LTextureRender( arrow, renderer, ( rightViewport.w - arrow->mWidth ) / 2,
+                    ( rightViewport.h - arrow->mHeight ) / 2, NULL, -angle,
+                    NULL, SDL_FLIP_HORIZONTAL );
+  }
+
+  // Back to the whole window
+  SDL_RenderSetViewport( renderer, NULL );
+}
+
+void renderDebugView( double angle ) {
+  SDL_Renderer* renderer = gDebugView.renderer;
+  LTexture* dots = LTextureRegistryGet( &gTextures, renderer, DOTS_PATH );
+  LTexture* arrow = LTextureRegistryGet( &gTextures, renderer, ARROW_PATH );
+
+  // Whole sheet with the arrow turning over it
+  if ( dots != NULL ) {
+    LTextureRender( dots, renderer, 0, 0, NULL, 0, NULL, SDL_FLIP_NONE );
+  }
+  if ( arrow != NULL ) {
+    LTextureRender( arrow, renderer, ( DEBUG_WIDTH - arrow->mWidth ) / 2,
+                    ( DEBUG_HEIGHT - arrow->mHeight ) / 2, NULL, angle, NULL,
+                    SDL_FLIP_VERTICAL );
+
+    // Shrinking thumbnails along the bottom edge
+    SDL_Rect thumbnail = { 0, 0, arrow->mWidth, arrow->mHeight };
+    for ( int i = 0; i < THUMBNAIL_COUNT; ++i ) {
+      thumbnail.w /= 2;
+      thumbnail.h /= 2;
+      thumbnail.y = DEBUG_HEIGHT - thumbnail.h;
+      LTextureRenderScaled( arrow, renderer, NULL, &thumbnail, angle, NULL,
+                            SDL_FLIP_NONE );
+      thumbnail.x += thumbnail.w;
+    }
+  }
+}
+
+int main() {
+  // Start up SDL and create window
+  if ( !init() ) {
+    printf( "Failed to initialize!\n" );
+  } else {
+    // Main loop flag
+    bool quit = false;
+
+    // Event handler
+    SDL_Event e;
+
+    // Angle of rotation
+    double angle = 0;
+
+    printf( "Press D to open or close the debug window\n" );
+
+    // While application is running
+    while ( !quit ) {
+      // Handle events on queue
+      while ( SDL_PollEvent( &e ) != 0 ) {
+        // User requests quit
+        if ( e.type == SDL_QUIT ) {
+          quit = true;
+        }
+        // Closing a window only closes that window unless it's the main one
+        else if ( e.type == SDL_WINDOWEVENT &&
+                  e.window.event == SDL_WINDOWEVENT_CLOSE ) {
+          if ( gDebugView.window != NULL &&
+               e.window.windowID == SDL_GetWindowID( gDebugView.window ) ) {
+            closeView( &gDebugView );
+          } else {
+            quit = true;
+          }
+        }
+        // Toggle debug window, reopening uploads without decoding again
+        else if ( e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_d ) {
+          if ( gDebugView.window != NULL ) {
+            closeView( &gDebugView );
+          }
+          // Main window alone paces the loop, a second vsynced present
+          // would wait for another refresh and halve the frame rate
+          else if ( !openView( &gDebugView, "Debug view", DEBUG_WIDTH,
+                               DEBUG_HEIGHT, false ) ) {
+            printf( "Failed to open debug window!\n" );
+          }
+        }
+      }
+
+      angle += ARROW_SPEED;
+
+      // Clear and draw main window
+      SDL_SetRenderDrawColor( gMainView.renderer, 0xFF, 0xFF, 0xFF, 0xFF );
+      SDL_RenderClear( gMainView.renderer );
+      renderMainView( angle );
+
+      // Clear and draw debug window
+      if ( gDebugView.renderer != NULL ) {
+        SDL_SetRenderDrawColor( gDebugView.renderer, 0x40, 0x40, 0x40, 0xFF );
+        SDL_RenderClear( gDebugView.renderer );
+        renderDebugView( angle );
+        SDL_RenderPresent( gDebugView.renderer );
+      }
+
+      // Update screen, the vsynced present last
+      SDL_RenderPresent( gMainView.renderer );
+    }
+  }
+
+  // Free resources and close SDL
+  close();
+
+  return 0;
+}
@@ -0,0 +1,469 @@
+#ifndef LPACK_H
+#define LPACK_H
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Pack file layout, all integers little endian
+//   header   "LPAK", version, entry count, slot count
+//   entries  LPACK_ENTRY_SIZE bytes each: path hash, name offset, name
+//            length, flags, data offset (64 bit), stored size, size
+//   slots    slot count entry indices + 1 by path hash, 0 when empty
+//   names    entry paths, not terminated
+//   data     asset bytes, LZ4 compressed when flagged
+#define LPACK_MAGIC "LPAK"
+#define LPACK_VERSION 1
+#define LPACK_HEADER_SIZE 16
+#define LPACK_ENTRY_SIZE 32
+
+// Entry data is one LZ4 block rather than stored bytes
+#define LPACK_FLAG_LZ4 1
+
+// Asset in an opened pack
+typedef struct LPackEntry LPackEntry;
+
+// Read only asset archive mapped into memory once
+// Assets are found through a hashed path index and handed out as SDL_RWops
+// over the mapping, so IMG_Load_RW and TTF_OpenFontRW read them unchanged.
+// Compressed assets are decompressed on first open and kept for later opens
+typedef struct LPack LPack;
+
+// creates LPack with default values
+LPack LPackNew( void );
+
+// Maps pack file at path and reads its index
+bool LPackOpen( LPack* lPack, const char* path );
+
+// Unmaps pack and frees decompressed assets
+void LPackFree( LPack* lPack );
+
+// Returns stream over asset stored under name, NULL when missing
+// Stream stays valid while the pack is open
+SDL_RWops* LPackOpenRW( LPack* lPack, const char* name );
+
+// Hashes asset path for the index
+Uint32 LPackHash( const char* name, size_t length );
+
+// Most bytes compressing size bytes can take
+size_t LPackCompressBound( size_t size );
+
+// Compresses source into one LZ4 block, returns 0 if it doesn't fit
+size_t LPackCompress( const Uint8* source, size_t size, Uint8* destination,
+                      size_t capacity );
+
+// Decompresses one LZ4 block, returns -1 on malformed input
+int LPackDecompress( const Uint8* source, size_t size, Uint8* destination,
+                     size_t capacity );
+
+typedef struct LPackEntry {
+  Uint32 mHash;
+  const char* mName;
+  Uint32 mNameLength;
+  Uint32 mFlags;
+
+  // Bytes in the mapping and their uncompressed size
+  const Uint8* mData;
+  Uint32 mStoredSize;
+  Uint32 mSize;
+
+  // Decompressed copy made on first open
+  Uint8* mDecoded;
+} LPackEntry;
+
+typedef struct LPack {
+  // File contents, mapped where possible
+  Uint8* mData;
+  size_t mSize;
+  bool mMapped;
+
+  LPackEntry* mEntries;
+  Uint32 mEntryCount;
+
+  // Hash slots in the mapping
+  const Uint8* mSlots;
+  Uint32 mSlotCount;
+
+  // Bytes decompressed so far
+  Uint64 mDecompressedBytes;
+} LPack;
+
+LPack LPackNew() {
+  LPack lPack;
+  memset( &lPack, 0, sizeof( lPack ) );
+  return lPack;
+}
+
+Uint32 LPackHash( const char* name, size_t length ) {
+  // FNV-1a
+  Uint32 hash = 2166136261u;
+  for ( size_t i = 0; i < length; ++i ) {
+    hash ^= (Uint8)name[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Reads little endian integers from unaligned memory
+static Uint32 LPackRead32( const Uint8* bytes ) {
+  Uint32 value;
+  memcpy( &value, bytes, sizeof( value ) );
+  return SDL_SwapLE32( value );
+}
+
+static Uint64 LPackRead64( const Uint8* bytes ) {
+  Uint64 value;
+  memcpy( &value, bytes, sizeof( value ) );
+  return SDL_SwapLE64( value );
+}
+
+// Maps pack file into memory, falling back to reading it
+static bool LPackLoadFile( LPack* lPack, const char* path ) {
+#ifndef _WIN32
+  FILE* stream = fopen( path, "rb" );
+  if ( stream != NULL ) {
+    struct stat info;
+    if ( fstat( fileno( stream ), &info ) == 0 && info.st_size > 0 ) {
+      void* data = mmap( NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE,
+                         fileno( stream ), 0 );
+      if ( data != MAP_FAILED ) {
+        lPack->mData = (Uint8*)data;
+        lPack->mSize = (size_t)info.st_size;
+        lPack->mMapped = true;
+      }
+    }
+
+    // Mapping stays valid after the descriptor is closed
+    fclose( stream );
+  }
+#endif
+
+  if ( lPack->mData == NULL ) {
+    lPack->mData = (Uint8*)SDL_LoadFile( path, &lPack->mSize );
+  }
+  if ( lPack->mData == NULL ) {
+    printf( "Unable to load pack %s! SDL Error: %s\n", path, SDL_GetError() );
+    return false;
+  }
+  return true;
+}
+
+bool LPackOpen( LPack* lPack, const char* path ) {
+  LPackFree( lPack );
+  if ( !LPackLoadFile( lPack, path ) ) {
+    return false;
+  }
+
+  // Check header
+  const Uint8* bytes = lPack->mData;
+  if ( lPack->mSize < LPACK_HEADER_SIZE ||
+       memcmp( bytes, LPACK_MAGIC, 4 ) != 0 ||
+       LPackRead32( bytes + 4 ) != LPACK_VERSION ) {
+    printf( "Unable to open pack %s! Not a version %d pack\n", path,
+            LPACK_VERSION );
+    LPackFree( lPack );
+    return false;
+  }
+  Uint32 entryCount = LPackRead32( bytes + 8 );
+  Uint32 slotCount = LPackRead32( bytes + 12 );
+  Uint64 indexEnd = LPACK_HEADER_SIZE + (Uint64)entryCount * LPACK_ENTRY_SIZE +
+                    (Uint64)slotCount * 4;
+  if ( indexEnd > lPack->mSize || slotCount < entryCount ||
+       ( slotCount & ( slotCount - 1 ) ) != 0 ) {
+    printf( "Unable to open pack %s! Index is corrupt\n", path );
+    LPackFree( lPack );
+    return false;
+  }
+
+  // Read entries, rejecting any that point outside the file
+  lPack->mEntries =
+      (LPackEntry*)calloc( (size_t)entryCount + 1, sizeof( LPackEntry ) );
+  if ( lPack->mEntries == NULL ) {
+    printf( "Unable to allocate pack index!\n" );
+    LPackFree( lPack );
+    return false;
+  }
+  for ( Uint32 i = 0; i < entryCount; ++i ) {
+    const Uint8* record = bytes + LPACK_HEADER_SIZE + i * LPACK_ENTRY_SIZE;
+    LPackEntry* entry = &lPack->mEntries[i];
+    Uint32 nameOffset = LPackRead32( record + 4 );
+    Uint64 dataOffset = LPackRead64( record + 16 );
+    entry->mHash = LPackRead32( record );
+    entry->mNameLength = LPackRead32( record + 8 );
+    entry->mFlags = LPackRead32( record + 12 );
+    entry->mStoredSize = LPackRead32( record + 24 );
+    entry->mSize = LPackRead32( record + 28 );
+    if ( (Uint64)nameOffset + entry->mNameLength > lPack->mSize ||
+         dataOffset + entry->mStoredSize > lPack->mSize ||
+         entry->mSize > (Uint32)SDL_MAX_SINT32 ) {
+      printf( "Unable to open pack %s! Entry %u is corrupt\n", path, i );
+      LPackFree( lPack );
+      return false;
+    }
+    entry->mName = (const char*)bytes + nameOffset;
+    entry->mData = bytes + dataOffset;
+  }
+  lPack->mEntryCount = entryCount;
+  lPack->mSlots = bytes + LPACK_HEADER_SIZE + entryCount * LPACK_ENTRY_SIZE;
+  lPack->mSlotCount = slotCount;
+  return true;
+}
+
+void LPackFree( LPack* lPack ) {
+  for ( Uint32 i = 0; i < lPack->mEntryCount; ++i ) {
+    free( lPack->mEntries[i].mDecoded );
+  }
+  free( lPack->mEntries );
+
+#ifndef _WIN32
+  if ( lPack->mMapped ) {
+    munmap( lPack->mData, lPack->mSize );
+  } else
+#endif
+  {
+    SDL_free( lPack->mData );
+  }
+
+  *lPack = LPackNew();
+}
+
+// Finds entry by linear probing from its hash slot
+static LPackEntry* LPackFind( LPack* lPack, const char* name ) {
+  if ( lPack->mSlotCount == 0 ) {
+    return NULL;
+  }
+  size_t length = strlen( name );
+  Uint32 hash = LPackHash( name, length );
+  for ( Uint32 probe = 0; probe < lPack->mSlotCount; ++probe ) {
+    Uint32 slot = ( hash + probe ) & ( lPack->mSlotCount - 1 );
+    Uint32 index = LPackRead32( lPack->mSlots + slot * 4 );
+    if ( index == 0 ) {
+      return NULL;
+    }
+    if ( index > lPack->mEntryCount ) {
+      continue;
+    }
+    LPackEntry* entry = &lPack->mEntries[index - 1];
+    if ( entry->mHash == hash && entry->mNameLength == length &&
+         memcmp( entry->mName, name, length ) == 0 ) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+SDL_RWops* LPackOpenRW( LPack* lPack, const char* name ) {
+  LPackEntry* entry = LPackFind( lPack, name );
+  if ( entry == NULL ) {
+    return NULL;
+  }
+
+  // Stored assets are read straight from the mapping
+  if ( !( entry->mFlags & LPACK_FLAG_LZ4 ) ) {
+    return SDL_RWFromConstMem( entry->mData, (int)entry->mStoredSize );
+  }
+
+  // Decompress on first use
+  if ( entry->mDecoded == NULL ) {
+    Uint8* decoded = (Uint8*)malloc( (size_t)entry->mSize + 1 );
+    if ( decoded == NULL ) {
+      printf( "Unable to allocate %s from pack!\n", name );
+      return NULL;
+    }
+    int length = LPackDecompress( entry->mData, entry->mStoredSize, decoded,
+                                  entry->mSize );
+    if ( length != (int)entry->mSize ) {
+      printf( "Unable to decompress %s from pack!\n", name );
+      free( decoded );
+      return NULL;
+    }
+    entry->mDecoded = decoded;
+    lPack->mDecompressedBytes += entry->mSize;
+  }
+  return SDL_RWFromConstMem( entry->mDecoded, (int)entry->mSize );
+}
+
+// LZ4 block format: sequences of a token (literal length high nibble, match
+// length - 4 low nibble, 15 meaning more length bytes follow), literals, and
+// a 16 bit back reference offset. The last sequence is literals only, the
+// last 5 bytes are always literals and no match starts in the last 12
+#define LPACK_MIN_MATCH 4
+#define LPACK_LAST_LITERALS 5
+#define LPACK_MATCH_LIMIT 12
+#define LPACK_HASH_BITS 12
+
+size_t LPackCompressBound( size_t size ) {
+  return size + size / 255 + 16;
+}
+
+// Writes length continuation bytes after a nibble of 15
+static bool LPackWriteLength( Uint8* destination, size_t capacity,
+                              size_t* out, size_t length ) {
+  for ( ; length >= 255; length -= 255 ) {
+    if ( *out >= capacity ) {
+      return false;
+    }
+    destination[( *out )++] = 255;
+  }
+  if ( *out >= capacity ) {
+    return false;
+  }
+  destination[( *out )++] = (Uint8)length;
+  return true;
+}
+
+// Writes literals and, if matchLength isn't 0, the match following them
+static bool LPackWriteSequence( Uint8* destination, size_t capacity,
+                                size_t* out, const Uint8* literals,
+                                size_t literalLength, size_t offset,
+                                size_t matchLength ) {
+  if ( *out >= capacity ) {
+    return false;
+  }
+  size_t matchCode = matchLength > 0 ? matchLength - LPACK_MIN_MATCH : 0;
+  Uint8* token = &destination[( *out )++];
+  *token = (Uint8)( ( literalLength < 15 ? literalLength : 15 ) << 4 |
+                    ( matchCode < 15 ? matchCode : 15 ) );
+  if ( literalLength >= 15 &&
+       !LPackWriteLength( destination, capacity, out, literalLength - 15 ) ) {
+    return false;
+  }
+
+  if ( capacity - *out < literalLength ) {
+    return false;
+  }
+  memcpy( destination + *out, literals, literalLength );
+  *out += literalLength;
+  if ( matchLength == 0 ) {
+    return true;
+  }
+
+  if ( capacity - *out < 2 ) {
+    return false;
+  }
+  destination[( *out )++] = (Uint8)( offset & 0xFF );
+  destination[( *out )++] = (Uint8)( offset >> 8 );
+  return matchCode < 15 ||
+         LPackWriteLength( destination, capacity, out, matchCode - 15 );
+}
+
+size_t LPackCompress( const Uint8* source, size_t size, Uint8* destination,
+                      size_t capacity ) {
+  // Last position seen for each hash of 4 bytes, + 1 so 0 means none
+  Uint32* table = (Uint32*)calloc( 1 << LPACK_HASH_BITS, sizeof( Uint32 ) );
+  if ( table == NULL ) {
+    return 0;
+  }
+
+  size_t out = 0;
+  size_t anchor = 0;
+  size_t position = 0;
+  while ( size > LPACK_MATCH_LIMIT && position < size - LPACK_MATCH_LIMIT ) {
+    Uint32 sequence;
+    memcpy( &sequence, source + position, sizeof( sequence ) );
+    Uint32 hash = ( sequence * 2654435761u ) >> ( 32 - LPACK_HASH_BITS );
+    size_t candidate = table[hash];
+    table[hash] = (Uint32)( position + 1 );
+
+    Uint32 previous;
+    if ( candidate == 0 || position - ( candidate - 1 ) > 0xFFFF ||
+         ( memcpy( &previous, source + candidate - 1, sizeof( previous ) ),
+           previous != sequence ) ) {
+      ++position;
+      continue;
+    }
+    size_t match = candidate - 1;
+
+    // Extend match, leaving the last literals alone
+    size_t length = LPACK_MIN_MATCH;
+    while ( position + length < size - LPACK_LAST_LITERALS &&
+            source[match + length] == source[position + length] ) {
+      ++length;
+    }
+
+    if ( !LPackWriteSequence( destination, capacity, &out, source + anchor,
+                              position - anchor, position - match,
+                              length ) ) {
+      free( table );
+      return 0;
+    }
+    position += length;
+    anchor = position;
+  }
+
+  // Remaining bytes as a final literal run
+  bool written = LPackWriteSequence( destination, capacity, &out,
+                                     source + anchor, size - anchor, 0, 0 );
+  free( table );
+  return written ? out : 0;
+}
+
+int LPackDecompress( const Uint8* source, size_t size, Uint8* destination,
+                     size_t capacity ) {
+  size_t in = 0;
+  size_t out = 0;
+  while ( in < size ) {
+    Uint8 token = source[in++];
+
+    // Copy literals
+    size_t literalLength = token >> 4;
+    if ( literalLength == 15 ) {
+      Uint8 extra;
+      do {
+        if ( in >= size ) {
+          return -1;
+        }
+        extra = source[in++];
+        literalLength += extra;
+      } while ( extra == 255 );
+    }
+    if ( size - in < literalLength || capacity - out < literalLength ) {
+      return -1;
+    }
+    memcpy( destination + out, source + in, literalLength );
+    in += literalLength;
+    out += literalLength;
+
+    // Last sequence has no match
+    if ( in == size ) {
+      break;
+    }
+
+    // Copy match byte by byte since it may overlap its own output
+    if ( size - in < 2 ) {
+      return -1;
+    }
+    size_t offset = (size_t)source[in] | (size_t)source[in + 1] << 8;
+    in += 2;
+    if ( offset == 0 || offset > out ) {
+      return -1;
+    }
+    size_t matchLength = token & 15;
+    if ( matchLength == 15 ) {
+      Uint8 extra;
+      do {
+        if ( in >= size ) {
+          return -1;
+        }
+        extra = source[in++];
+        matchLength += extra;
+      } while ( extra == 255 );
+    }
+    matchLength += LPACK_MIN_MATCH;
+    if ( capacity - out < matchLength ) {
+      return -1;
+    }
+    for ( size_t i = 0; i < matchLength; ++i, ++out ) {
+      destination[out] = destination[out - offset];
+    }
+  }
+  return out <= (size_t)SDL_MAX_SINT32 ? (int)out : -1;
+}
+
+#endif
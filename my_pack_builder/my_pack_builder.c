@@ -0,0 +1,274 @@
+// Using SDL, standard IO and the asset pack format
+#include "LPack.h"
+
+// Asset being packed
+typedef struct Asset {
+  // Path given on the command line, stored as the asset name
+  const char* name;
+  size_t nameLength;
+
+  // File contents and the bytes written to the pack
+  Uint8* data;
+  size_t size;
+  Uint8* compressed;
+  size_t storedSize;
+} Asset;
+
+// Starts up SDL
+bool init( void );
+
+// Frees assets and shuts down SDL
+void close( void );
+
+// Reads and compresses every file named on the command line
+bool loadAssets( int count, char* paths[] );
+
+// Writes pack index and asset data to path
+bool writePack( const char* path );
+
+// Reopens pack at path and checks every asset reads back unchanged
+bool verifyPack( const char* path );
+
+// Assets in the order they were given
+Asset* gAssets = NULL;
+int gAssetCount = 0;
+
+bool init() {
+  // Initialize SDL
+  if ( SDL_Init( 0 ) < 0 ) {
+    printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+  return true;
+}
+
+void close() {
+  for ( int i = 0; i < gAssetCount; ++i ) {
+    SDL_free( gAssets[i].data );
+    free( gAssets[i].compressed );
+  }
+  free( gAssets );
+  gAssets = NULL;
+  gAssetCount = 0;
+
+  // Quit SDL subsystems
+  SDL_Quit();
+}
+
+bool loadAssets( int count, char* paths[] ) {
+  gAssets = (Asset*)calloc( (size_t)count, sizeof( Asset ) );
+  if ( gAssets == NULL ) {
+    printf( "Unable to allocate assets!\n" );
+    return false;
+  }
+
+  for ( int i = 0; i < count; ++i ) {
+    Asset* asset = &gAssets[gAssetCount++];
+    asset->name = paths[i];
+    asset->nameLength = strlen( paths[i] );
+    for ( int j = 0; j < i; ++j ) {
+      if ( strcmp( gAssets[j].name, asset->name ) == 0 ) {
+        printf( "Unable to pack %s twice!\n", asset->name );
+        return false;
+      }
+    }
+
+    asset->data = (Uint8*)SDL_LoadFile( asset->name, &asset->size );
+    if ( asset->data == NULL ) {
+      printf( "Unable to load %s! SDL Error: %s\n", asset->name,
+              SDL_GetError() );
+      return false;
+    }
+    if ( asset->size > (size_t)SDL_MAX_SINT32 ) {
+      printf( "Unable to pack %s! Assets must be under 2 GB\n", asset->name );
+      return false;
+    }
+
+    // Keep compressed block only if it saves space and decodes back exactly
+    size_t bound = LPackCompressBound( asset->size );
+    asset->compressed = (Uint8*)malloc( bound );
+    Uint8* check = (Uint8*)malloc( asset->size + 1 );
+    if ( asset->compressed == NULL || check == NULL ) {
+      printf( "Unable to allocate buffers for %s!\n", asset->name );
+      free( check );
+      return false;
+    }
+    asset->storedSize =
+        LPackCompress( asset->data, asset->size, asset->compressed, bound );
+    if ( asset->storedSize > 0 ) {
+      int length = LPackDecompress( asset->compressed, asset->storedSize,
+                                    check, asset->size );
+      if ( length != (int)asset->size ||
+           memcmp( check, asset->data, asset->size ) != 0 ) {
+        printf( "Unable to compress %s! Round trip mismatch\n", asset->name );
+        free( check );
+        return false;
+      }
+    }
+    free( check );
+    if ( asset->storedSize == 0 || asset->storedSize >= asset->size ) {
+      free( asset->compressed );
+      asset->compressed = NULL;
+      asset->storedSize = asset->size;
+    }
+  }
+  return true;
+}
+
+// Writes little endian integers to unaligned memory
+static void write32( Uint8* bytes, Uint32 value ) {
+  value = SDL_SwapLE32( value );
+  memcpy( bytes, &value, sizeof( value ) );
+}
+
+static void write64( Uint8* bytes, Uint64 value ) {
+  value = SDL_SwapLE64( value );
+  memcpy( bytes, &value, sizeof( value ) );
+}
+
+bool writePack( const char* path ) {
+  // Keep hash table at most half full
+  Uint32 entryCount = (Uint32)gAssetCount;
+  Uint32 slotCount = 1;
+  while ( slotCount < entryCount * 2 ) {
+    slotCount *= 2;
+  }
+
+  // Lay out index, names, then data
+  size_t namesOffset = LPACK_HEADER_SIZE + entryCount * LPACK_ENTRY_SIZE +
+                       slotCount * 4;
+  size_t dataOffset = namesOffset;
+  for ( int i = 0; i < gAssetCount; ++i ) {
+    dataOffset += gAssets[i].nameLength;
+  }
+  size_t packSize = dataOffset;
+  for ( int i = 0; i < gAssetCount; ++i ) {
+    packSize += gAssets[i].storedSize;
+  }
+
+  Uint8* pack = (Uint8*)calloc( packSize, 1 );
+  if ( pack == NULL ) {
+    printf( "Unable to allocate %lu byte pack!\n", (unsigned long)packSize );
+    return false;
+  }
+  memcpy( pack, LPACK_MAGIC, 4 );
+  write32( pack + 4, LPACK_VERSION );
+  write32( pack + 8, entryCount );
+  write32( pack + 12, slotCount );
+
+  Uint8* slots = pack + LPACK_HEADER_SIZE + entryCount * LPACK_ENTRY_SIZE;
+  size_t nameOffset = namesOffset;
+  for ( Uint32 i = 0; i < entryCount; ++i ) {
+    const Asset* asset = &gAssets[i];
+    Uint32 hash = LPackHash( asset->name, asset->nameLength );
+
+    // Entry record
+    Uint8* record = pack + LPACK_HEADER_SIZE + i * LPACK_ENTRY_SIZE;
+    write32( record, hash );
+    write32( record + 4, (Uint32)nameOffset );
+    write32( record + 8, (Uint32)asset->nameLength );
+    write32( record + 12, asset->compressed != NULL ? LPACK_FLAG_LZ4 : 0 );
+    write64( record + 16, dataOffset );
+    write32( record + 24, (Uint32)asset->storedSize );
+    write32( record + 28, (Uint32)asset->size );
+
+    // First free slot from the hash
+    Uint32 slot = hash & ( slotCount - 1 );
+    while ( LPackRead32( slots + slot * 4 ) != 0 ) {
+      slot = ( slot + 1 ) & ( slotCount - 1 );
+    }
+    write32( slots + slot * 4, i + 1 );
+
+    memcpy( pack + nameOffset, asset->name, asset->nameLength );
+    nameOffset += asset->nameLength;
+    memcpy( pack + dataOffset,
+            asset->compressed != NULL ? asset->compressed : asset->data,
+            asset->storedSize );
+    dataOffset += asset->storedSize;
+  }
+
+  SDL_RWops* file = SDL_RWFromFile( path, "wb" );
+  if ( file == NULL ) {
+    printf( "Unable to create %s! SDL Error: %s\n", path, SDL_GetError() );
+    free( pack );
+    return false;
+  }
+  bool written = SDL_RWwrite( file, pack, 1, packSize ) == packSize;
+  if ( SDL_RWclose( file ) != 0 || !written ) {
+    printf( "Unable to write %s! SDL Error: %s\n", path, SDL_GetError() );
+    written = false;
+  }
+  free( pack );
+  return written;
+}
+
+bool verifyPack( const char* path ) {
+  LPack lPack = LPackNew();
+  if ( !LPackOpen( &lPack, path ) ) {
+    return false;
+  }
+
+  bool success = true;
+  Uint64 start = SDL_GetPerformanceCounter();
+  for ( int i = 0; i < gAssetCount && success; ++i ) {
+    const Asset* asset = &gAssets[i];
+    SDL_RWops* stream = LPackOpenRW( &lPack, asset->name );
+    if ( stream == NULL ) {
+      printf( "Unable to find %s in pack!\n", asset->name );
+      success = false;
+      break;
+    }
+    Uint8* data = (Uint8*)malloc( asset->size + 1 );
+    success = data != NULL && SDL_RWsize( stream ) == (Sint64)asset->size &&
+              SDL_RWread( stream, data, 1, asset->size ) == asset->size &&
+              memcmp( data, asset->data, asset->size ) == 0;
+    if ( !success ) {
+      printf( "Unable to read %s back from pack!\n", asset->name );
+    }
+    free( data );
+    SDL_RWclose( stream );
+  }
+  Uint64 end = SDL_GetPerformanceCounter();
+
+  if ( success && lPack.mDecompressedBytes > 0 ) {
+    double seconds =
+        (double)( end - start ) / (double)SDL_GetPerformanceFrequency();
+    printf( "Decompressed %.1f KB in %.2f ms\n",
+            (double)lPack.mDecompressedBytes / 1024.0, seconds * 1000.0 );
+  }
+  LPackFree( &lPack );
+  return success;
+}
+
+int main( int argc, char* argv[] ) {
+  if ( argc < 3 ) {
+    printf( "Usage: %s <pack> <file>...\n", argv[0] );
+    return 1;
+  }
+
+  // Start up SDL and read assets
+  bool success = init() && loadAssets( argc - 2, argv + 2 ) &&
+                 writePack( argv[1] ) && verifyPack( argv[1] );
+  if ( success ) {
+    // Per asset and total compression
+    size_t size = 0;
+    size_t stored = 0;
+    for ( int i = 0; i < gAssetCount; ++i ) {
+      const Asset* asset = &gAssets[i];
+      printf( "%-48s %9lu -> %9lu %s\n", asset->name,
+              (unsigned long)asset->size, (unsigned long)asset->storedSize,
+              asset->compressed != NULL ? "lz4" : "stored" );
+      size += asset->size;
+      stored += asset->storedSize;
+    }
+    printf( "Packed %d assets into %s, %lu -> %lu bytes\n", gAssetCount,
+            argv[1], (unsigned long)size, (unsigned long)stored );
+  } else {
+    printf( "Failed to build pack!\n" );
+  }
+
+  // Free resources and close SDL
+  close();
+
+  return success ? 0 : 1;
+}
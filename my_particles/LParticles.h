@@ -0,0 +1,285 @@
+#ifndef LPARTICLES_H
+#define LPARTICLES_H
+
+#include "LTexture.h"
+#include <math.h>
+#include <stdlib.h>
+#if defined( __SSE__ ) || defined( _M_X64 )
+#include <xmmintrin.h>
+#define LPARTICLES_SSE
+#endif
+
+// Particle system struct
+// Positions, velocities, lifetimes and colors live in separate arrays so the
+// update streams through them four floats at a time with SSE, which every
+// x86-64 build has without extra flags. Other targets use the scalar loop.
+// Dead particles are swapped out for the last live one, keeping the arrays
+// packed. Every live particle is drawn as a quad of one sprite in a single
+// geometry batch, its color in the vertices modulating the sprite the way
+// LTextureSetColor and LTextureSetAlpha do, with alpha fading over its life
+typedef struct LParticles LParticles;
+
+// creates LParticles with default values
+LParticles LParticlesNew( void );
+
+// Deallocates LParticles
+void LParticlesFree( LParticles* lParticles );
+
+// Allocates room for capacity particles
+bool LParticlesCreate( LParticles* lParticles, int capacity );
+
+// Spawns count particles at given point flying in random directions up to
+// speed pixels per second for up to lifetime seconds
+// Returns how many fit
+int LParticlesEmit( LParticles* lParticles, float x, float y, int count,
+                    float speed, float lifetime, SDL_Color color );
+
+// Moves particles forward by seconds and removes the ones that died
+void LParticlesUpdate( LParticles* lParticles, float seconds );
+
+// Draws particles as clip of sprite, whole sprite if clip is NULL
+void LParticlesRender( LParticles* lParticles, SDL_Renderer* gRenderer,
+                       LTexture* sprite, SDL_Rect* clip );
+
+typedef struct LParticles {
+  // Particle attributes, one array each
+  float* mX;
+  float* mY;
+  float* mVelocityX;
+  float* mVelocityY;
+
+  // Seconds left to live and seconds lived in total
+  float* mLife;
+  float* mLifetime;
+
+  SDL_Color* mColors;
+
+  int mCount;
+  int mCapacity;
+
+  // Downward acceleration in pixels per second squared
+  float mGravity;
+
+  // Side of a particle's quad in pixels
+  float mSize;
+
+  // Batch of four vertices and six indices per particle
+  SDL_Vertex* mVertices;
+  int* mIndices;
+
+  // Random number state for emitting
+  Uint32 mSeed;
+} LParticles;
+
+LParticles LParticlesNew() {
+  LParticles lParticles = { NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                            0,    0,    0.f,  4.f,  NULL, NULL, 2463534242u };
+  return lParticles;
+}
+
+void LParticlesFree( LParticles* lParticles ) {
+  free( lParticles->mX );
+  free( lParticles->mY );
+  free( lParticles->mVelocityX );
+  free( lParticles->mVelocityY );
+  free( lParticles->mLife );
+  free( lParticles->mLifetime );
+  free( lParticles->mColors );
+  free( lParticles->mVertices );
+  free( lParticles->mIndices );
+
+  // Keep settings for the next Create
+  float gravity = lParticles->mGravity;
+  float size = lParticles->mSize;
+  *lParticles = LParticlesNew();
+  lParticles->mGravity = gravity;
+  lParticles->mSize = size;
+}
+
+bool LParticlesCreate( LParticles* lParticles, int capacity ) {
+  // Get rid of preexisting particles
+  LParticlesFree( lParticles );
+
+  size_t floats = sizeof( float ) * (size_t)capacity;
+  lParticles->mX = (float*)malloc( floats );
+  lParticles->mY = (float*)malloc( floats );
+  lParticles->mVelocityX = (float*)malloc( floats );
+  lParticles->mVelocityY = (float*)malloc( floats );
+  lParticles->mLife = (float*)malloc( floats );
+  lParticles->mLifetime = (float*)malloc( floats );
+  lParticles->mColors =
+      (SDL_Color*)malloc( sizeof( SDL_Color ) * (size_t)capacity );
+  lParticles->mVertices =
+      (SDL_Vertex*)malloc( sizeof( SDL_Vertex ) * 4 * (size_t)capacity );
+  lParticles->mIndices = (int*)malloc( sizeof( int ) * 6 * (size_t)capacity );
+  if ( lParticles->mX == NULL || lParticles->mY == NULL ||
+       lParticles->mVelocityX == NULL || lParticles->mVelocityY == NULL ||
+       lParticles->mLife == NULL || lParticles->mLifetime == NULL ||
+       lParticles->mColors == NULL || lParticles->mVertices == NULL ||
+       lParticles->mIndices == NULL ) {
+    printf( "Unable to allocate %d particles!\n", capacity );
+    LParticlesFree( lParticles );
+    return false;
+  }
+
+  // Quads never change their corner order, so indices are set once
+  for ( int i = 0; i < capacity; ++i ) {
+    int* indices = &lParticles->mIndices[i * 6];
+    indices[0] = i * 4;
+    indices[1] = i * 4 + 1;
+    indices[2] = i * 4 + 2;
+    indices[3] = i * 4 + 2;
+    indices[4] = i * 4 + 3;
+    indices[5] = i * 4;
+  }
+  lParticles->mCapacity = capacity;
+  return true;
+}
+
+// Returns random number from 0 up to but not including 1
+static float LParticlesRandom( LParticles* lParticles ) {
+  // Xorshift
+  Uint32 seed = lParticles->mSeed;
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  lParticles->mSeed = seed;
+  return (float)( seed >> 8 ) / 16777216.f;
+}
+
+int LParticlesEmit( LParticles* lParticles, float x, float y, int count,
+                    float speed, float lifetime, SDL_Color color ) {
+  count = SDL_min( count, lParticles->mCapacity - lParticles->mCount );
+  for ( int n = 0; n < count; ++n ) {
+    int i = lParticles->mCount++;
+    float angle = LParticlesRandom( lParticles ) * 6.2831853f;
+    float velocity = LParticlesRandom( lParticles ) * speed;
+    lParticles->mX[i] = x;
+    lParticles->mY[i] = y;
+    lParticles->mVelocityX[i] = cosf( angle ) * velocity;
+    lParticles->mVelocityY[i] = sinf( angle ) * velocity;
+
+    // Live at least half of lifetime so nothing vanishes right away
+    lParticles->mLifetime[i] =
+        lifetime * ( 0.5f + 0.5f * LParticlesRandom( lParticles ) );
+    lParticles->mLife[i] = lParticles->mLifetime[i];
+    lParticles->mColors[i] = color;
+  }
+  return count;
+}
+
+// Applies gravity, moves particles and counts down their lives
+// SSE runs first, the scalar loop finishes the last few particles
+static void LParticlesIntegrate( LParticles* lParticles, float seconds ) {
+  float* x = lParticles->mX;
+  float* y = lParticles->mY;
+  float* velocityX = lParticles->mVelocityX;
+  float* velocityY = lParticles->mVelocityY;
+  float* life = lParticles->mLife;
+  float fall = lParticles->mGravity * seconds;
+  int count = lParticles->mCount;
+  int i = 0;
+
+#ifdef LPARTICLES_SSE
+  __m128 seconds4 = _mm_set1_ps( seconds );
+  __m128 fall4 = _mm_set1_ps( fall );
+  for ( ; i + 4 <= count; i += 4 ) {
+    __m128 vy = _mm_add_ps( _mm_loadu_ps( velocityY + i ), fall4 );
+    _mm_storeu_ps( velocityY + i, vy );
+    _mm_storeu_ps( x + i,
+                   _mm_add_ps( _mm_loadu_ps( x + i ),
+                               _mm_mul_ps( _mm_loadu_ps( velocityX + i ),
+                                           seconds4 ) ) );
+    _mm_storeu_ps( y + i, _mm_add_ps( _mm_loadu_ps( y + i ),
+                                      _mm_mul_ps( vy, seconds4 ) ) );
+    _mm_storeu_ps( life + i, _mm_sub_ps( _mm_loadu_ps( life + i ), seconds4 ) );
+  }
+#endif
+
+  for ( ; i < count; ++i ) {
+    velocityY[i] += fall;
+    x[i] += velocityX[i] * seconds;
+    y[i] += velocityY[i] * seconds;
+    life[i] -= seconds;
+  }
+}
+
+void LParticlesUpdate( LParticles* lParticles, float seconds ) {
+  LParticlesIntegrate( lParticles, seconds );
+
+  // Fill holes left by dead particles with the last live ones
+  int i = 0;
+  while ( i < lParticles->mCount ) {
+    if ( lParticles->mLife[i] > 0.f ) {
+      ++i;
+      continue;
+    }
+    int last = --lParticles->mCount;
+    lParticles->mX[i] = lParticles->mX[last];
+    lParticles->mY[i] = lParticles->mY[last];
+    lParticles->mVelocityX[i] = lParticles->mVelocityX[last];
+    lParticles->mVelocityY[i] = lParticles->mVelocityY[last];
+    lParticles->mLife[i] = lParticles->mLife[last];
+    lParticles->mLifetime[i] = lParticles->mLifetime[last];
+    lParticles->mColors[i] = lParticles->mColors[last];
+  }
+}
+
+void LParticlesRender( LParticles* lParticles, SDL_Renderer* gRenderer,
+                       LTexture* sprite, SDL_Rect* clip ) {
+  if ( lParticles->mCount == 0 ) {
+    return;
+  }
+
+  // Texture coordinates of clip
+  SDL_Rect source = { 0, 0, sprite->mWidth, sprite->mHeight };
+  if ( clip != NULL ) {
+    source = *clip;
+  }
+  float left = (float)source.x / (float)sprite->mWidth;
+  float top = (float)source.y / (float)sprite->mHeight;
+  float right = (float)( source.x + source.w ) / (float)sprite->mWidth;
+  float bottom = (float)( source.y + source.h ) / (float)sprite->mHeight;
+  float half = lParticles->mSize / 2.f;
+
+  for ( int i = 0; i < lParticles->mCount; ++i ) {
+    // Fade alpha out with the life left
+    SDL_Color color = lParticles->mColors[i];
+    color.a = (Uint8)( (float)color.a * SDL_min( lParticles->mLife[i] /
+                                                      lParticles->mLifetime[i],
+                                                  1.f ) );
+
+    SDL_Vertex* vertices = &lParticles->mVertices[i * 4];
+    float x = lParticles->mX[i];
+    float y = lParticles->mY[i];
+    vertices[0].position.x = x - half;
+    vertices[0].position.y = y - half;
+    vertices[0].tex_coord.x = left;
+    vertices[0].tex_coord.y = top;
+    vertices[1].position.x = x + half;
+    vertices[1].position.y = y - half;
+    vertices[1].tex_coord.x = right;
+    vertices[1].tex_coord.y = top;
+    vertices[2].position.x = x + half;
+    vertices[2].position.y = y + half;
+    vertices[2].tex_coord.x = right;
+    vertices[2].tex_coord.y = bottom;
+    vertices[3].position.x = x - half;
+    vertices[3].position.y = y + half;
+    vertices[3].tex_coord.x = left;
+    vertices[3].tex_coord.y = bottom;
+    for ( int corner = 0; corner < 4; ++corner ) {
+      vertices[corner].color = color;
+    }
+  }
+
+  // One draw for every particle
+  SDL_AtomicIncRef( &gLTextureDrawCalls );
+  if ( SDL_RenderGeometry( gRenderer, sprite->mTexture, lParticles->mVertices,
+                           lParticles->mCount * 4, lParticles->mIndices,
+                           lParticles->mCount * 6 ) != 0 ) {
+    printf( "Failed to render particles! SDL Error: %s\n", SDL_GetError() );
+  }
+}
+
+#endif
@@ -0,0 +1,226 @@
+// Using SDL, standard IO, and the particle system
+#include "LParticles.h"
+
+// Screen dimension constants
+const int SCREEN_WIDTH = 640;
+const int SCREEN_HEIGHT = 480;
+
+// Most particles alive at once
+const int MAX_PARTICLES = 300000;
+
+// Particles spawned per frame while emitting
+const int EMIT_PER_FRAME = 4000;
+
+// Particle motion in pixels per second and seconds
+const float SPARK_SPEED = 240.f;
+const float SPARK_LIFETIME = 1.5f;
+const float SPARK_GRAVITY = 300.f;
+
+// Side of the soft dot sprite
+#define SPARK_SPRITE_SIZE 16
+
+// Starts up SDL and creates window
+bool init( void );
+
+// Makes sprite and particle arrays
+bool loadMedia( void );
+
+// Frees media and shuts down SDL
+void close( void );
+
+// Returns color of emitted sparks, slowly going round the hues
+SDL_Color sparkColor( int frame );
+
+// The window we'll be rendering to
+SDL_Window* gWindow = NULL;
+
+// The window renderer
+SDL_Renderer* gRenderer = NULL;
+
+// White dot every particle tints
+LTexture gSparkTexture;
+
+// The sparks
+LParticles gSparks;
+
+bool init() {
+  // Initialize SDL
+  if ( SDL_Init( SDL_INIT_VIDEO ) < 0 ) {
+    printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  // Create window
+  gWindow = SDL_CreateWindow( "SDL Tutorial", SDL_WINDOWPOS_UNDEFINED,
+                              SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH,
+                              SCREEN_HEIGHT, SDL_WINDOW_SHOWN );
+  if ( gWindow == NULL ) {
+    printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  // Create vsynced renderer for window
+  gRenderer = SDL_CreateRenderer(
+      gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+  if ( gRenderer == NULL ) {
+    printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  gSparkTexture = LTextureNew();
+  gSparks = LParticlesNew();
+  return true;
+}
+
+bool loadMedia() {
+  // Draw white dot fading out towards its edge
+  SDL_Surface* dot = SDL_CreateRGBSurfaceWithFormat(
+      0, SPARK_SPRITE_SIZE, SPARK_SPRITE_SIZE, 32, SDL_PIXELFORMAT_ARGB8888 );
+  if ( dot == NULL ) {
+    printf( "Unable to create spark surface! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+  float radius = SPARK_SPRITE_SIZE / 2.f;
+  for ( int y = 0; y < SPARK_SPRITE_SIZE; ++y ) {
+    Uint32* row = (Uint32*)( (Uint8*)dot->pixels + y * dot->pitch );
+    for ( int x = 0; x < SPARK_SPRITE_SIZE; ++x ) {
+      float dx = ( (float)x + 0.5f - radius ) / radius;
+      float dy = ( (float)y + 0.5f - radius ) / radius;
+      float falloff = SDL_max( 1.f - sqrtf( dx * dx + dy * dy ), 0.f );
+      row[x] = SDL_MapRGBA( dot->format, 0xFF, 0xFF, 0xFF,
+                            (Uint8)( falloff * 255.f ) );
+    }
+  }
+  bool success =
+      LTextureLoadFromSurface( &gSparkTexture, gRenderer, dot, "spark" );
+  SDL_FreeSurface( dot );
+  if ( !success ) {
+    printf( "Failed to create spark texture!\n" );
+    return false;
+  }
+
+  // Overlapping sparks add up to white
+  LTextureSetBlendMode( &gSparkTexture, SDL_BLENDMODE_ADD );
+
+  gSparks.mGravity = SPARK_GRAVITY;
+  gSparks.mSize = (float)SPARK_SPRITE_SIZE / 2.f;
+  if ( !LParticlesCreate( &gSparks, MAX_PARTICLES ) ) {
+    printf( "Failed to create particles!\n" );
+    return false;
+  }
+  return true;
+}
+
+void close() {
+  // Free loaded images
+  LParticlesFree( &gSparks );
+  LTextureFree( &gSparkTexture );
+  LTextureFreeStaging();
+
+  // Destroy window
+  SDL_DestroyRenderer( gRenderer );
+  SDL_DestroyWindow( gWindow );
+  gWindow = NULL;
+  gRenderer = NULL;
+
+  // Quit SDL subsystems
+  SDL_Quit();
+}
+
+SDL_Color sparkColor( int frame ) {
+  // Three waves a third of a turn apart
+  float phase = (float)frame * 0.02f;
+  SDL_Color color = {
+      (Uint8)( 127.5f + 127.5f * sinf( phase ) ),
+      (Uint8)( 127.5f + 127.5f * sinf( phase + 2.0943951f ) ),
+      (Uint8)( 127.5f + 127.5f * sinf( phase + 4.1887902f ) ), 0xFF };
+  return color;
+}
+
+int main() {
+  // Start up SDL and create window
+  if ( !init() ) {
+    printf( "Failed to initialize!\n" );
+  } else {
+    // Load media
+    if ( !loadMedia() ) {
+      printf( "Failed to load media!\n" );
+    } else {
+      // Main loop flag
+      bool quit = false;
+
+      // Event handler
+      SDL_Event e;
+
+      // Where sparks come from, follows the mouse
+      float emitterX = (float)SCREEN_WIDTH / 2.f;
+      float emitterY = (float)SCREEN_HEIGHT / 3.f;
+      bool emitting = true;
+
+      // Current animation frame
+      int frame = 0;
+
+      // Update and draw time summed over all frames
+      Uint64 updateTicks = 0;
+      Uint64 renderTicks = 0;
+
+      printf( "Move the mouse to aim, space pauses emitting, S prints "
+              "stats\n" );
+
+      // While application is running
+      while ( !quit ) {
+        // Handle events on queue
+        while ( SDL_PollEvent( &e ) != 0 ) {
+          // User requests quit
+          if ( e.type == SDL_QUIT ) {
+            quit = true;
+          } else if ( e.type == SDL_MOUSEMOTION ) {
+            emitterX = (float)e.motion.x;
+            emitterY = (float)e.motion.y;
+          } else if ( e.type == SDL_KEYDOWN ) {
+            if ( e.key.keysym.sym == SDLK_SPACE ) {
+              emitting = !emitting;
+            }
+            // Average update and draw times so far
+            else if ( e.key.keysym.sym == SDLK_s && frame > 0 ) {
+              double toMs = 1000.0 / (double)SDL_GetPerformanceFrequency() /
+                            (double)frame;
+              printf( "%d particles, update %.3f ms, draw %.3f ms\n",
+                      gSparks.mCount, (double)updateTicks * toMs,
+                      (double)renderTicks * toMs );
+            }
+          }
+        }
+
+        // Spawn and move sparks at a fixed step
+        Uint64 start = SDL_GetPerformanceCounter();
+        if ( emitting ) {
+          LParticlesEmit( &gSparks, emitterX, emitterY, EMIT_PER_FRAME,
+                          SPARK_SPEED, SPARK_LIFETIME, sparkColor( frame ) );
+        }
+        LParticlesUpdate( &gSparks, 1.f / 60.f );
+        Uint64 updated = SDL_GetPerformanceCounter();
+        updateTicks += updated - start;
+
+        // Clear screen
+        SDL_SetRenderDrawColor( gRenderer, 0x00, 0x00, 0x00, 0xFF );
+        SDL_RenderClear( gRenderer );
+
+        // Render every spark in one batch
+        LParticlesRender( &gSparks, gRenderer, &gSparkTexture, NULL );
+        renderTicks += SDL_GetPerformanceCounter() - updated;
+
+        // Update screen
+        SDL_RenderPresent( gRenderer );
+
+        // Go to next frame
+        ++frame;
+      }
+    }
+  }
+
+  // Free resources and close SDL
+  close();
+
+  return 0;
+}
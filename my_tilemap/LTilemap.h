@@ -0,0 +1,399 @@
+#ifndef LTILEMAP_H
+#define LTILEMAP_H
+
+#include "LLayer.h"
+#include "LTexture.h"
+#include <stdlib.h>
+
+// Tiles along each side of a chunk
+#define LTILEMAP_CHUNK_TILES 16
+
+// Chunk layers kept at once, least recently drawn ones are freed past this
+#define LTILEMAP_MAX_CACHED_CHUNKS 32
+
+// Tile of a cell with nothing in it
+#define LTILEMAP_EMPTY -1
+
+// Tile cycling through consecutive clips of the tileset
+typedef struct LTilemapAnimation LTilemapAnimation;
+
+// Square block of cells cached in one layer
+typedef struct LTilemapChunk LTilemapChunk;
+
+// Grid of tiles drawn from clips of one tileset texture
+// Cells are stored in fixed size chunks. The static tiles of a chunk are
+// drawn once into a cached layer and redrawn only when one of them changes,
+// so a frame costs a copy per visible chunk however large the map is.
+// Animated tiles are kept in a list per chunk and drawn over its layer every
+// frame. Tiles below the tileset's clip count are clips, tiles from there on
+// are the animations in the order they were added
+typedef struct LTilemap LTilemap;
+
+// creates LTilemap with default values
+LTilemap LTilemapNew( void );
+
+// Deallocates LTilemap, the tileset is left to its owner
+void LTilemapFree( LTilemap* lTilemap );
+
+// Creates empty map of columns by rows cells of tileSize pixels, drawn from
+// clipSize squares of tileset
+bool LTilemapCreate( LTilemap* lTilemap, LTexture* tileset, int clipSize,
+                     int tileSize, int columns, int rows );
+
+// Adds tile showing frameCount clips from firstClip for frameTicks frames
+// each, returns the tile or LTILEMAP_EMPTY on failure
+int LTilemapAddAnimation( LTilemap* lTilemap, int firstClip, int frameCount,
+                          int frameTicks );
+
+// Sets tile of cell, cells outside the map are ignored
+void LTilemapSetTile( LTilemap* lTilemap, int column, int row, int tile );
+
+// Returns tile of cell, LTILEMAP_EMPTY outside the map
+int LTilemapGetTile( LTilemap* lTilemap, int column, int row );
+
+// Marks cached chunks as changed, call on SDL_RENDER_TARGETS_RESET
+void LTilemapInvalidate( LTilemap* lTilemap );
+
+// Draws chunks overlapping camera, animation frame picks animated clips
+void LTilemapRender( LTilemap* lTilemap, SDL_Renderer* gRenderer,
+                     SDL_Rect* camera, int frame );
+
+// Prints chunks drawn and redrawn by the last render
+void LTilemapPrintStats( LTilemap* lTilemap );
+
+typedef struct LTilemapAnimation {
+  int mFirstClip;
+  int mFrameCount;
+  int mFrameTicks;
+} LTilemapAnimation;
+
+typedef struct LTilemapChunk {
+  Sint16 mTiles[LTILEMAP_CHUNK_TILES * LTILEMAP_CHUNK_TILES];
+
+  // Cells holding animated tiles
+  Uint16 mAnimated[LTILEMAP_CHUNK_TILES * LTILEMAP_CHUNK_TILES];
+  int mAnimatedCount;
+
+  // Cells holding clips, an empty chunk gets no layer
+  int mStaticCount;
+
+  // Static tiles, without a texture while not cached
+  LLayer mLayer;
+
+  // Render the chunk was last visible in
+  int mLastDrawn;
+} LTilemapChunk;
+
+typedef struct LTilemap {
+  // Clips of tileset
+  LTexture* mTileset;
+  int mClipSize;
+  int mClipColumns;
+  int mClipCount;
+
+  // Size of a cell on screen
+  int mTileSize;
+
+  // Map dimensions in cells and in chunks
+  int mColumns;
+  int mRows;
+  int mChunkColumns;
+  int mChunkRows;
+  LTilemapChunk* mChunks;
+
+  LTilemapAnimation* mAnimations;
+  int mAnimationCount;
+
+  // Chunks that have a layer texture
+  int mCached[LTILEMAP_MAX_CACHED_CHUNKS];
+  int mCachedCount;
+
+  // Renders so far, and chunks drawn and redrawn by the last one
+  int mRenderCount;
+  int mDrawnChunks;
+  int mRedrawnChunks;
+} LTilemap;
+
+LTilemap LTilemapNew() {
+  LTilemap lTilemap = { NULL, 0, 0, 0, 0, 0, 0, 0, 0,
+                        NULL, NULL, 0, { 0 }, 0, 0, 0, 0 };
+  return lTilemap;
+}
+
+void LTilemapFree( LTilemap* lTilemap ) {
+  for ( int i = 0; i < lTilemap->mCachedCount; ++i ) {
+    LLayerFree( &lTilemap->mChunks[lTilemap->mCached[i]].mLayer );
+  }
+  free( lTilemap->mChunks );
+  free( lTilemap->mAnimations );
+  *lTilemap = LTilemapNew();
+}
+
+bool LTilemapCreate( LTilemap* lTilemap, LTexture* tileset, int clipSize,
+                     int tileSize, int columns, int rows ) {
+  // Get rid of preexisting map
+  LTilemapFree( lTilemap );
+
+  int chunkColumns =
+      ( columns + LTILEMAP_CHUNK_TILES - 1 ) / LTILEMAP_CHUNK_TILES;
+  int chunkRows = ( rows + LTILEMAP_CHUNK_TILES - 1 ) / LTILEMAP_CHUNK_TILES;
+  LTilemapChunk* chunks = (LTilemapChunk*)malloc(
+      sizeof( LTilemapChunk ) * (size_t)chunkColumns * (size_t)chunkRows );
+  if ( chunks == NULL ) {
+    printf( "Unable to allocate %dx%d tilemap!\n", columns, rows );
+    return false;
+  }
+  for ( int i = 0; i < chunkColumns * chunkRows; ++i ) {
+    LTilemapChunk* chunk = &chunks[i];
+    for ( int cell = 0; cell < LTILEMAP_CHUNK_TILES * LTILEMAP_CHUNK_TILES;
+          ++cell ) {
+      chunk->mTiles[cell] = LTILEMAP_EMPTY;
+    }
+    chunk->mAnimatedCount = 0;
+    chunk->mStaticCount = 0;
+    chunk->mLayer = LLayerNew();
+    chunk->mLastDrawn = 0;
+  }
+
+  lTilemap->mTileset = tileset;
+  lTilemap->mClipSize = clipSize;
+  lTilemap->mClipColumns = tileset->mWidth / clipSize;
+  lTilemap->mClipCount =
+      lTilemap->mClipColumns * ( tileset->mHeight / clipSize );
+  lTilemap->mTileSize = tileSize;
+  lTilemap->mColumns = columns;
+  lTilemap->mRows = rows;
+  lTilemap->mChunkColumns = chunkColumns;
+  lTilemap->mChunkRows = chunkRows;
+  lTilemap->mChunks = chunks;
+  return true;
+}
+
+int LTilemapAddAnimation( LTilemap* lTilemap, int firstClip, int frameCount,
+                          int frameTicks ) {
+  LTilemapAnimation* animations = (LTilemapAnimation*)realloc(
+      lTilemap->mAnimations,
+      sizeof( LTilemapAnimation ) * (size_t)( lTilemap->mAnimationCount + 1 ) );
+  if ( animations == NULL ) {
+    printf( "Unable to allocate tile animation!\n" );
+    return LTILEMAP_EMPTY;
+  }
+  lTilemap->mAnimations = animations;
+
+  LTilemapAnimation* animation = &animations[lTilemap->mAnimationCount];
+  animation->mFirstClip = firstClip;
+  animation->mFrameCount = SDL_max( frameCount, 1 );
+  animation->mFrameTicks = SDL_max( frameTicks, 1 );
+  return lTilemap->mClipCount + lTilemap->mAnimationCount++;
+}
+
+// Returns whether tile is a clip drawn into the chunk's layer
+static bool LTilemapIsStatic( LTilemap* lTilemap, int tile ) {
+  return tile >= 0 && tile < lTilemap->mClipCount;
+}
+
+// Returns whether tile is one of the animations
+static bool LTilemapIsAnimated( LTilemap* lTilemap, int tile ) {
+  return tile >= lTilemap->mClipCount &&
+         tile < lTilemap->mClipCount + lTilemap->mAnimationCount;
+}
+
+void LTilemapSetTile( LTilemap* lTilemap, int column, int row, int tile ) {
+  if ( column < 0 || column >= lTilemap->mColumns || row < 0 ||
+       row >= lTilemap->mRows ) {
+    return;
+  }
+  LTilemapChunk* chunk =
+      &lTilemap->mChunks[row / LTILEMAP_CHUNK_TILES * lTilemap->mChunkColumns +
+                         column / LTILEMAP_CHUNK_TILES];
+  int cell = row % LTILEMAP_CHUNK_TILES * LTILEMAP_CHUNK_TILES +
+             column % LTILEMAP_CHUNK_TILES;
+  int previous = chunk->mTiles[cell];
+  if ( previous == tile ) {
+    return;
+  }
+
+  // Take out previous tile
+  if ( LTilemapIsStatic( lTilemap, previous ) ) {
+    --chunk->mStaticCount;
+    LLayerInvalidate( &chunk->mLayer );
+  } else if ( LTilemapIsAnimated( lTilemap, previous ) ) {
+    for ( int i = 0; i < chunk->mAnimatedCount; ++i ) {
+      if ( chunk->mAnimated[i] == cell ) {
+        chunk->mAnimated[i] = chunk->mAnimated[--chunk->mAnimatedCount];
+        break;
+      }
+    }
+  }
+
+  // Put in new one, unknown tiles leave the cell empty
+  if ( LTilemapIsStatic( lTilemap, tile ) ) {
+    ++chunk->mStaticCount;
+    LLayerInvalidate( &chunk->mLayer );
+  } else if ( LTilemapIsAnimated( lTilemap, tile ) ) {
+    chunk->mAnimated[chunk->mAnimatedCount++] = (Uint16)cell;
+  } else {
+    tile = LTILEMAP_EMPTY;
+  }
+  chunk->mTiles[cell] = (Sint16)tile;
+}
+
+int LTilemapGetTile( LTilemap* lTilemap, int column, int row ) {
+  if ( column < 0 || column >= lTilemap->mColumns || row < 0 ||
+       row >= lTilemap->mRows ) {
+    return LTILEMAP_EMPTY;
+  }
+  LTilemapChunk* chunk =
+      &lTilemap->mChunks[row / LTILEMAP_CHUNK_TILES * lTilemap->mChunkColumns +
+                         column / LTILEMAP_CHUNK_TILES];
+  return chunk->mTiles[row % LTILEMAP_CHUNK_TILES * LTILEMAP_CHUNK_TILES +
+                       column % LTILEMAP_CHUNK_TILES];
+}
+
+void LTilemapInvalidate( LTilemap* lTilemap ) {
+  for ( int i = 0; i < lTilemap->mCachedCount; ++i ) {
+    LLayerInvalidate( &lTilemap->mChunks[lTilemap->mCached[i]].mLayer );
+  }
+}
+
+// Draws clip of tileset into cell at given point
+static void LTilemapDrawClip( LTilemap* lTilemap, SDL_Renderer* gRenderer,
+                              int clip, int x, int y ) {
+  SDL_Rect source = { clip % lTilemap->mClipColumns * lTilemap->mClipSize,
+                      clip / lTilemap->mClipColumns * lTilemap->mClipSize,
+                      lTilemap->mClipSize, lTilemap->mClipSize };
+  SDL_Rect destination = { x, y, lTilemap->mTileSize, lTilemap->mTileSize };
+  LTextureRenderScaled( lTilemap->mTileset, gRenderer, &source, &destination,
+                        0, NULL, SDL_FLIP_NONE );
+}
+
+// Draws static tiles of chunk with its corner at given point
+static void LTilemapDrawStatic( LTilemap* lTilemap, LTilemapChunk* chunk,
+                                SDL_Renderer* gRenderer, int x, int y ) {
+  for ( int cell = 0; cell < LTILEMAP_CHUNK_TILES * LTILEMAP_CHUNK_TILES;
+        ++cell ) {
+    if ( LTilemapIsStatic( lTilemap, chunk->mTiles[cell] ) ) {
+      LTilemapDrawClip(
+          lTilemap, gRenderer, chunk->mTiles[cell],
+          x + cell % LTILEMAP_CHUNK_TILES * lTilemap->mTileSize,
+          y + cell / LTILEMAP_CHUNK_TILES * lTilemap->mTileSize );
+    }
+  }
+}
+
+// Draws static tiles of chunk into its layer
+// Texels are copied with their alpha instead of blended, so alpha is applied
+// once when the layer is composited, the same as for tiles drawn straight to
+// the screen. Cells don't overlap, so nothing underneath is lost
+static void LTilemapDrawCached( LTilemap* lTilemap, LTilemapChunk* chunk,
+                                SDL_Renderer* gRenderer ) {
+  SDL_BlendMode blending;
+  if ( SDL_GetTextureBlendMode( lTilemap->mTileset->mTexture, &blending ) !=
+       0 ) {
+    blending = SDL_BLENDMODE_BLEND;
+  }
+  LTextureSetBlendMode( lTilemap->mTileset, SDL_BLENDMODE_NONE );
+  LTilemapDrawStatic( lTilemap, chunk, gRenderer, 0, 0 );
+  LTextureSetBlendMode( lTilemap->mTileset, blending );
+}
+
+// Gives chunk a layer texture, freeing the least recently drawn one if the
+// cache is full. Returns false if every cached chunk is visible
+static bool LTilemapCacheChunk( LTilemap* lTilemap, LTilemapChunk* chunk,
+                                SDL_Renderer* gRenderer ) {
+  if ( chunk->mLayer.mTexture != NULL ) {
+    return true;
+  }
+
+  int slot = lTilemap->mCachedCount;
+  if ( slot == LTILEMAP_MAX_CACHED_CHUNKS ) {
+    int oldest = lTilemap->mRenderCount;
+    for ( int i = 0; i < lTilemap->mCachedCount; ++i ) {
+      LTilemapChunk* cached = &lTilemap->mChunks[lTilemap->mCached[i]];
+      if ( cached->mLastDrawn < oldest ) {
+        oldest = cached->mLastDrawn;
+        slot = i;
+      }
+    }
+    if ( slot == LTILEMAP_MAX_CACHED_CHUNKS ) {
+      return false;
+    }
+    LLayerFree( &lTilemap->mChunks[lTilemap->mCached[slot]].mLayer );
+  }
+
+  int chunkSize = LTILEMAP_CHUNK_TILES * lTilemap->mTileSize;
+  if ( !LLayerCreate( &chunk->mLayer, gRenderer, chunkSize, chunkSize ) ) {
+    if ( slot < lTilemap->mCachedCount ) {
+      lTilemap->mCached[slot] = lTilemap->mCached[--lTilemap->mCachedCount];
+    }
+    return false;
+  }
+  lTilemap->mCached[slot] = (int)( chunk - lTilemap->mChunks );
+  if ( slot == lTilemap->mCachedCount ) {
+    ++lTilemap->mCachedCount;
+  }
+  return true;
+}
+
+void LTilemapRender( LTilemap* lTilemap, SDL_Renderer* gRenderer,
+                     SDL_Rect* camera, int frame ) {
+  ++lTilemap->mRenderCount;
+  lTilemap->mDrawnChunks = 0;
+  lTilemap->mRedrawnChunks = 0;
+
+  // Chunks overlapping camera
+  int chunkSize = LTILEMAP_CHUNK_TILES * lTilemap->mTileSize;
+  int firstColumn = SDL_max( camera->x / chunkSize, 0 );
+  int firstRow = SDL_max( camera->y / chunkSize, 0 );
+  int lastColumn = SDL_min( ( camera->x + camera->w - 1 ) / chunkSize,
+                            lTilemap->mChunkColumns - 1 );
+  int lastRow = SDL_min( ( camera->y + camera->h - 1 ) / chunkSize,
+                         lTilemap->mChunkRows - 1 );
+
+  for ( int row = firstRow; row <= lastRow; ++row ) {
+    for ( int column = firstColumn; column <= lastColumn; ++column ) {
+      LTilemapChunk* chunk =
+          &lTilemap->mChunks[row * lTilemap->mChunkColumns + column];
+      int x = column * chunkSize - camera->x;
+      int y = row * chunkSize - camera->y;
+      chunk->mLastDrawn = lTilemap->mRenderCount;
+
+      // Static tiles from the layer, drawn straight if it can't be cached
+      if ( chunk->mStaticCount > 0 ) {
+        if ( LTilemapCacheChunk( lTilemap, chunk, gRenderer ) ) {
+          if ( LLayerBegin( &chunk->mLayer, gRenderer ) ) {
+            LTilemapDrawCached( lTilemap, chunk, gRenderer );
+            LLayerEnd( &chunk->mLayer, gRenderer );
+            ++lTilemap->mRedrawnChunks;
+          }
+          LLayerRender( &chunk->mLayer, gRenderer, x, y );
+        } else {
+          LTilemapDrawStatic( lTilemap, chunk, gRenderer, x, y );
+        }
+      }
+
+      // Animated tiles on top
+      for ( int i = 0; i < chunk->mAnimatedCount; ++i ) {
+        int cell = chunk->mAnimated[i];
+        LTilemapAnimation* animation =
+            &lTilemap->mAnimations[chunk->mTiles[cell] - lTilemap->mClipCount];
+        int clip = animation->mFirstClip + frame / animation->mFrameTicks %
+                                               animation->mFrameCount;
+        LTilemapDrawClip(
+            lTilemap, gRenderer, clip,
+            x + cell % LTILEMAP_CHUNK_TILES * lTilemap->mTileSize,
+            y + cell / LTILEMAP_CHUNK_TILES * lTilemap->mTileSize );
+      }
+      ++lTilemap->mDrawnChunks;
+    }
+  }
+}
+
+void LTilemapPrintStats( LTilemap* lTilemap ) {
+  printf( "Tilemap: %d chunks drawn, %d redrawn, %d of %d cached\n",
+          lTilemap->mDrawnChunks, lTilemap->mRedrawnChunks,
+          lTilemap->mCachedCount,
+          lTilemap->mChunkColumns * lTilemap->mChunkRows );
+}
+
+#endif
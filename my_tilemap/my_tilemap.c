@@ -0,0 +1,264 @@
+// Using SDL, SDL_image, standard IO, and the chunked tilemap
+#include "LTilemap.h"
+
+// Screen dimension constants
+const int SCREEN_WIDTH = 640;
+const int SCREEN_HEIGHT = 480;
+
+// Map dimensions in cells, far bigger than the screen
+const int MAP_COLUMNS = 512;
+const int MAP_ROWS = 512;
+
+// Size of a tileset clip and of a cell on screen
+const int CLIP_SIZE = 100;
+const int TILE_SIZE = 32;
+
+// Pixels the camera moves per frame while an arrow key is held
+const int CAMERA_SPEED = 8;
+
+// Frames each clip of the animated tile shows for
+const int ANIMATION_TICKS = 8;
+
+// Starts up SDL and creates window
+bool init( void );
+
+// Loads tileset and fills map
+bool loadMedia( void );
+
+// Frees media and shuts down SDL
+void close( void );
+
+// Fills map with a pattern of dots, some of them animated
+void generateMap( int animatedTile );
+
+// Cycles clips of cells around camera center
+void paintAround( SDL_Rect* camera );
+
+// The window we'll be rendering to
+SDL_Window* gWindow = NULL;
+
+// The window renderer
+SDL_Renderer* gRenderer = NULL;
+
+// Scene textures
+LTexture gTileset;
+LTilemap gTilemap;
+
+bool init() {
+  // Initialize SDL
+  if ( SDL_Init( SDL_INIT_VIDEO ) < 0 ) {
+    printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  // Create window
+  gWindow = SDL_CreateWindow( "SDL Tutorial", SDL_WINDOWPOS_UNDEFINED,
+                              SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH,
+                              SCREEN_HEIGHT, SDL_WINDOW_SHOWN );
+  if ( gWindow == NULL ) {
+    printf( "Window could not be created! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  // Create vsynced renderer for window
+  gRenderer = SDL_CreateRenderer(
+      gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+  if ( gRenderer == NULL ) {
+    printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+    return false;
+  }
+
+  // Initialize PNG loading
+  int imgFlags = IMG_INIT_PNG;
+  if ( !( IMG_Init( imgFlags ) & imgFlags ) ) {
+    printf( "SDL_image could not initialize! SDL_image Error: %s\n",
+            IMG_GetError() );
+    return false;
+  }
+
+  gTileset = LTextureNew();
+  gTilemap = LTilemapNew();
+  return true;
+}
+
+bool loadMedia() {
+  // Clips are drawn at a third of their size, so give them mip levels
+  LTextureSetMipmapped( &gTileset, true );
+  char* path = "11_clip_rendering_and_sprite_sheets/dots.png";
+  if ( !LTextureLoadFromFile( &gTileset, gRenderer, path ) ) {
+    printf( "Failed to load tileset!\n" );
+    return false;
+  }
+
+  if ( !LTilemapCreate( &gTilemap, &gTileset, CLIP_SIZE, TILE_SIZE,
+                        MAP_COLUMNS, MAP_ROWS ) ) {
+    printf( "Failed to create tilemap!\n" );
+    return false;
+  }
+
+  // Animated tile cycling through all four dots
+  int animatedTile = LTilemapAddAnimation( &gTilemap, 0, gTilemap.mClipCount,
+                                           ANIMATION_TICKS );
+  if ( animatedTile == LTILEMAP_EMPTY ) {
+    return false;
+  }
+  generateMap( animatedTile );
+  return true;
+}
+
+void close() {
+  LTilemapPrintStats( &gTilemap );
+
+  // Free loaded images
+  LTilemapFree( &gTilemap );
+  LTextureFree( &gTileset );
+  LTextureFreeStaging();
+
+  // Destroy window
+  SDL_DestroyRenderer( gRenderer );
+  SDL_DestroyWindow( gWindow );
+  gWindow = NULL;
+  gRenderer = NULL;
+
+  // Quit SDL subsystems
+  IMG_Quit();
+  SDL_Quit();
+}
+
+void generateMap( int animatedTile ) {
+  for ( int row = 0; row < MAP_ROWS; ++row ) {
+    for ( int column = 0; column < MAP_COLUMNS; ++column ) {
+      // Scramble cell position into a repeatable pattern
+      unsigned int hash = (unsigned int)( column * 73856093 ^ row * 19349663 );
+      hash ^= hash >> 13;
+      int tile;
+      if ( hash % 61 == 0 ) {
+        tile = animatedTile;
+      } else if ( hash % 7 == 0 ) {
+        tile = LTILEMAP_EMPTY;
+      } else {
+        tile = (int)( ( column / 8 + row / 8 ) % 4 );
+      }
+      LTilemapSetTile( &gTilemap, column, row, tile );
+    }
+  }
+}
+
+void paintAround( SDL_Rect* camera ) {
+  int centerColumn = ( camera->x + camera->w / 2 ) / TILE_SIZE;
+  int centerRow = ( camera->y + camera->h / 2 ) / TILE_SIZE;
+  for ( int row = centerRow - 1; row <= centerRow + 1; ++row ) {
+    for ( int column = centerColumn - 1; column <= centerColumn + 1;
+          ++column ) {
+      int tile = LTilemapGetTile( &gTilemap, column, row );
+      if ( tile >= 0 && tile < gTilemap.mClipCount ) {
+        LTilemapSetTile( &gTilemap, column, row,
+                         ( tile + 1 ) % gTilemap.mClipCount );
+      }
+    }
+  }
+}
+
+int main() {
+  // Start up SDL and create window
+  if ( !init() ) {
+    printf( "Failed to initialize!\n" );
+  } else {
+    // Load media
+    if ( !loadMedia() ) {
+      printf( "Failed to load media!\n" );
+    } else {
+      // Main loop flag
+      bool quit = false;
+
+      // Event handler
+      SDL_Event e;
+
+      // Visible part of the map and its velocity
+      SDL_Rect camera = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+      int velocityX = 0;
+      int velocityY = 0;
+
+      // Current animation frame
+      int frame = 0;
+
+      printf( "Arrow keys scroll, E paints the center, S prints stats\n" );
+
+      // While application is running
+      while ( !quit ) {
+        // Handle events on queue
+        while ( SDL_PollEvent( &e ) != 0 ) {
+          // User requests quit
+          if ( e.type == SDL_QUIT ) {
+            quit = true;
+          }
+          // Target textures lost their contents
+          else if ( e.type == SDL_RENDER_TARGETS_RESET ) {
+            LTilemapInvalidate( &gTilemap );
+          }
+          // Arrow keys set velocity while held
+          else if ( ( e.type == SDL_KEYDOWN || e.type == SDL_KEYUP ) &&
+                    e.key.repeat == 0 ) {
+            int speed = e.type == SDL_KEYDOWN ? CAMERA_SPEED : -CAMERA_SPEED;
+            switch ( e.key.keysym.sym ) {
+            case SDLK_UP:
+              velocityY -= speed;
+              break;
+
+            case SDLK_DOWN:
+              velocityY += speed;
+              break;
+
+            case SDLK_LEFT:
+              velocityX -= speed;
+              break;
+
+            case SDLK_RIGHT:
+              velocityX += speed;
+              break;
+
+            case SDLK_e:
+              if ( e.type == SDL_KEYDOWN ) {
+                paintAround( &camera );
+              }
+              break;
+
+            case SDLK_s:
+              if ( e.type == SDL_KEYDOWN ) {
+                LTilemapPrintStats( &gTilemap );
+              }
+              break;
+
+            default:
+              break;
+            }
+          }
+        }
+
+        // Move camera, keeping it over the map
+        camera.x = SDL_max( 0, SDL_min( camera.x + velocityX,
+                                        MAP_COLUMNS * TILE_SIZE - camera.w ) );
+        camera.y = SDL_max( 0, SDL_min( camera.y + velocityY,
+                                        MAP_ROWS * TILE_SIZE - camera.h ) );
+
+        // Clear screen
+        SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+        SDL_RenderClear( gRenderer );
+
+        // Render visible chunks
+        LTilemapRender( &gTilemap, gRenderer, &camera, frame );
+
+        // Update screen
+        SDL_RenderPresent( gRenderer );
+
+        // Go to next frame
+        ++frame;
+      }
+    }
+  }
+
+  // Free resources and close SDL
+  close();
+
+  return 0;
+}